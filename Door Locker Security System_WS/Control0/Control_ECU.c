@@ -5,10 +5,25 @@
  */
 
 #include "external_eeprom.h"
+#include "storage.h"
+#include "cred_store.h"
+#include "user_table.h"
+#include "pin_hash.h"
+#include "challenge.h"
+#include "audit_log.h"
+#include "counters.h"
+#include "lockout.h"
+#include "tick.h"
 #include "buzzer.h"
 #include "dc_motor.h"
+#include "door.h"
+#include "watchdog.h"
 #include "avr/io.h"
 #include"uart.h"
+#include "baud.h"
+#include "link.h"
+#include "idle.h"
+#include <avr/interrupt.h>
 #include "twi.h"
 #include <util/delay.h>
 #include "timer1.h"
@@ -16,65 +31,236 @@
 
 
 #define MAX_DIGITS 					5
+/* frame of a new user: its PIN then its role, so the role is authenticated with the PIN */
+#define USER_FRAME_SIZE             (MAX_DIGITS + 1)
+#define USER_FRAME_ROLE_INDEX       MAX_DIGITS
 #define MATCHED 					1
 #define MISMATCHED 					0
 #define MC_ADDRESS 					0x0E1
-#define EEPROM_FIRST_ADDRESS_VALUE  0x10
 #define SENDING_FIRST_PASSWORD      0x0F
 #define SENDING_SECOND_PASSWORD     0x0E
 #define OPEN_DOOR_MODE              0x0D
 #define CHANGE_PASSWORD		        0x0C
-#define MAX_SPEED_FOR_DC_MOTER		100
+#define ADD_USER                    0x0B
+#define REMOVE_USER                 0x0A
+#define EXPORT_AUDIT_LOG            0x06
 #define CTC_VALUE_FOR_ONE_SECOND 	7813
 #define CTC_INITIAL_VALUE 			0
-#define TIME_FOR_UNLOKING_THE_DOOR  15
-#define TIME_FOR_LOKING_THE_DOOR    15
 #define DOOR_HOLD_TIME              3
 #define BUZZER_ON                   0xB0
 #define BUZZER_OFF                  0xBF
-#define BUZZER_ON_PERIOD			60
 #define THERE_IS_PASSWORD_OR_NO     0x09
 #define THERE_IS_PASSWORD           0x08
 #define THERE_IS_NO_PASSWORD        0x07
+#define LOCKED_OUT                  0x05
+#define NOT_LOCKED_OUT              0x04
+#define DOOR_REPORT_AT_END          0x03
+#define DOOR_REPORT_JAMMED          0x02
+#define RESET_REPORT                0x10
+/* the main loop and its waits check in at least this often or the watchdog resets the ECU */
+#define MAIN_LOOP_DEADLINE_MS       2000UL
+/*
+ * the bytes of an order follow it at once, the longest frame takes 33ms at 9600.
+ * Computed bound, not measured: an order is followed by at most 2 frames, each cut one costs
+ * this deadline plus UART_RESYNC_MAX_MS, so a broken exchange is left within 800ms, under
+ * MAIN_LOOP_DEADLINE_MS
+ */
+#define RECEIVE_TIMEOUT_MS          200
 
 
 
 uint8 password[MAX_DIGITS]={0};
 uint8 password_check[MAX_DIGITS]={0};
+uint8 user_pin[USER_FRAME_SIZE]={0};
+/* stored credential: salt then hash of the password */
+uint8 g_credential[PIN_HASH_RECORD_SIZE]={0};
+uint8 g_pinHash[PIN_HASH_SIZE]={0};
+/* lookup tag of the entered PIN and answer of the HMI to the open door challenge */
+uint8 g_tag[CHALLENGE_TAG_SIZE]={0};
+uint8 g_response[CHALLENGE_RESPONSE_SIZE]={0};
+UserTable_EntryType g_user;
+uint8 g_lastUser=AUDIT_USER_NONE;
 uint8 g_commandRececived=0;
 uint8 g_currentMode=0;
 uint8 g_ticks=0;
 uint8 g_passwordSatate=THERE_IS_NO_PASSWORD;
+/* result of the last encrypted frame, a forged or replayed one never matches */
+uint8 g_linkStatus=ERROR;
+boolean g_isFirstPasswordValid=FALSE;
+uint8 g_mainTask=WATCHDOG_NO_TASK;
+/* every reset is reported to HMI_ECU with its next question, it then starts a new link boot */
+boolean g_isResetReportPending=TRUE;
+/* cycles of a PIN check and of a link frame counted at boot, see their budgets */
+uint32 g_pinHashCycles=0;
+uint32 g_linkFrameCycles=0;
 
-/*Saving password in EEPROM*/
+/*Saving the salted hash of the password in EEPROM as a new record of the credential log*/
 void savePasswordToEEPROM(void)
 {
-	for(uint8 i=0;i<MAX_DIGITS;i++)
+	PinHash_newSalt(g_credential);
+	PinHash_compute(g_credential,password,MAX_DIGITS,&g_credential[PIN_HASH_SALT_SIZE]);
+	CredStore_save(g_credential, PIN_HASH_RECORD_SIZE);
+}
+
+/*read the salt and the hash of the password*/
+uint8 readPasswordFromEEPROM(uint8*arr)
+{
+	return CredStore_load(arr, PIN_HASH_RECORD_SIZE);
+}
+
+/*compare in constant time so the time does not tell how many digits are right*/
+uint8 checkTwoArray(uint8*arr1,uint8*arr2,uint8 length)
+{
+	return PinHash_isEqual(arr1,arr2,length) ? MATCHED : MISMATCHED;
+}
+
+/* check a received password against the system password then the user table */
+uint8 checkPassword(uint8*arr,boolean adminOnly)
+{
+	uint8 slot;
+
+	/* remember who entered it for the audit log */
+	g_lastUser=AUDIT_USER_NONE;
+	if(readPasswordFromEEPROM(g_credential) == SUCCESS)
+	{
+		/* hash the received password with the stored salt and compare the hashes */
+		PinHash_compute(g_credential,arr,MAX_DIGITS,g_pinHash);
+		if(checkTwoArray(g_pinHash,&g_credential[PIN_HASH_SALT_SIZE],PIN_HASH_SIZE))
+		{
+			g_lastUser=AUDIT_USER_SYSTEM;
+			return MATCHED;
+		}
+	}
+	slot=UserTable_find(arr,&g_user);
+	if((slot != USER_NOT_FOUND) && (g_user.flags & USER_FLAG_ENABLED))
 	{
-		EEPROM_writeByte(EEPROM_FIRST_ADDRESS_VALUE + i, password[i]);
-		_delay_ms(20);
+		if((!adminOnly) || (g_user.flags & USER_FLAG_ADMIN))
+		{
+			g_lastUser=slot;
+			return MATCHED;
+		}
 	}
+	return MISMATCHED;
 }
 
-void readPasswordFromEEPROM(uint8*arr)
+/* check the answer to the open door challenge */
+uint8 checkResponse(const uint8*response)
 {
-	for(uint8 i=0;i<MAX_DIGITS;i++)
+	uint8 result=Challenge_check(response);
+
+	/* remember who entered it for the audit log */
+	g_lastUser=AUDIT_USER_NONE;
+	if(result == CHALLENGE_SYSTEM)
+	{
+		g_lastUser=AUDIT_USER_SYSTEM;
+		return MATCHED;
+	}
+	if(result != USER_NOT_FOUND)
 	{
-		EEPROM_readByte(EEPROM_FIRST_ADDRESS_VALUE+i,password[i]);
-		_delay_ms(20);
+		g_lastUser=result;
+		return MATCHED;
 	}
+	return MISMATCHED;
 }
 
-uint8 checkTwoArray(uint8*arr1,uint8*arr2,uint8 length)
+/* wait until the lockout record is in the EEPROM, a power cut after the answer cannot undo the failure */
+void waitLockoutSaved(void)
 {
-	for(uint8 i=0;i<length;i++)
+	while(Storage_isBusy(STORAGE_LOCKOUT))
 	{
-		if(arr1[i]!=arr2[i])
+		Watchdog_checkIn(g_mainTask);
+		/* the EEPROM ready interrupt wakes the CPU for each byte */
+		cli();
+		if(Storage_isBusy(STORAGE_LOCKOUT))
 		{
-			return MISMATCHED;
+			Idle_sleep();
 		}
+		sei();
+	}
+}
+
+/* count a wrong password, send the mismatch and the time before the next try once it is saved,
+   then start the alarm if it locks the system */
+void rejectPassword(void)
+{
+	uint16 retryAfter;
+
+	retryAfter=Lockout_recordFailure();
+	waitLockoutSaved();
+	UART_sendByte(MISMATCHED);
+	UART_sendByte((uint8)retryAfter);
+	UART_sendByte((uint8)(retryAfter>>8));
+	AuditLog_record(AUDIT_EVENT_WRONG_PIN,AUDIT_USER_NONE);
+	Counters_add(COUNTER_FAILED_ATTEMPTS,1);
+	if(retryAfter != 0)
+	{
+		AuditLog_record(AUDIT_EVENT_ALARM,AUDIT_USER_NONE);
+		/* one minute alarm played in the background, the orders are still served */
+		Buzzer_play(BUZZER_PATTERN_ALARM);
+	}
+	else
+	{
+		Buzzer_play(BUZZER_PATTERN_LOCKOUT_WARNING);
+	}
+}
+
+/* reject a request during a lockout with the seconds left */
+void sendLockedOut(void)
+{
+	uint16 retryAfter=Lockout_getRetryAfter();
+
+	UART_sendByte(LOCKED_OUT);
+	UART_sendByte((uint8)retryAfter);
+	UART_sendByte((uint8)(retryAfter>>8));
+}
+
+/* check the admin password of the user administration orders, it counts toward the lockout
+   and a failure is saved before the caller answers */
+uint8 checkAdmin(void)
+{
+	if((Lockout_getRetryAfter() != 0) || (g_linkStatus != SUCCESS))
+	{
+		return MISMATCHED;
+	}
+	if(checkPassword(password,TRUE))
+	{
+		Lockout_recordSuccess();
+		return MATCHED;
+	}
+	Lockout_recordFailure();
+	waitLockoutSaved();
+	AuditLog_record(AUDIT_EVENT_WRONG_PIN,AUDIT_USER_NONE);
+	Counters_add(COUNTER_FAILED_ATTEMPTS,1);
+	return MISMATCHED;
+}
+
+/* move the door until its end switch, then report the result to HMI_ECU */
+Door_Status moveDoor(Door_Direction direction)
+{
+	Door_Status status;
+
+	Door_move(direction);
+	/* the motor is stopped by the end switch interrupt or by the timeout,
+	   the tick wakes the CPU each 1ms to check it */
+	while((status=Door_getStatus()) == DOOR_MOVING)
+	{
+		Watchdog_checkIn(g_mainTask);
+		cli();
+		Idle_sleep();
+	}
+
+	Counters_add(COUNTER_MOTOR_SECONDS,(Door_getTravelMs()+500)/1000);
+	if(status == DOOR_JAMMED)
+	{
+		UART_sendByte(DOOR_REPORT_JAMMED);
+		AuditLog_record(AUDIT_EVENT_DOOR_JAMMED,g_lastUser);
+		Buzzer_play(BUZZER_PATTERN_LOCKOUT_WARNING);
+	}
+	else
+	{
+		UART_sendByte(DOOR_REPORT_AT_END);
 	}
-	return MATCHED;
+	return status;
 }
 
 /* this function is executed each 1 second*/
@@ -93,7 +279,17 @@ void DelaySecondTimer1(uint8 timeSec)
 	/*Configuration For TIMER1 */
 	Timer1_init(&Config_Ptr1);
 	/* waiting for 15 seconds until the door is unlocking */
-	while (g_ticks < timeSec);
+	/* sleep between the timer interrupts */
+	while (g_ticks < timeSec)
+	{
+		Watchdog_checkIn(g_mainTask);
+		cli();
+		if(g_ticks < timeSec)
+		{
+			Idle_sleep();
+		}
+		sei();
+	}
 	g_ticks = 0;
 	/* stop the timer1 */
 	Timer1_deInit();
@@ -105,41 +301,128 @@ int main(void)
 {
 	// Enable global interrupts
 	SREG=1<<7;
+	/* read the reset cause first, save the trace of a watchdog reset */
+	Watchdog_init();
+	/* the waits for a byte, a key or a timer sleep instead of spinning */
+	Idle_init();
 	//select settings for uart
-	UART_ConfigType uart_config_1={EIGHT_BITS,DISABLED,ONE_BITS,9600};
+	UART_ConfigType uart_config_1={EIGHT_BITS,DISABLED,ONE_BITS,BAUD_SAFE_RATE};
 	UART_init(&uart_config_1);
+	/* HMI_ECU opens the negotiation of a faster rate, a watchdog reset keeps the agreed one */
+	Baud_init(BAUD_CONTROL);
+	/* the passwords cross the wire encrypted and authenticated */
+	Link_init(LINK_CONTROL);
 	/* select the configuration of TWI */
-	TWI_ConfigType twi_config_1 ={MC_ADDRESS, FAST_MODE_400_KB_PER_SEC};
+	TWI_ConfigType twi_config_1 ={MC_ADDRESS, FAST_MODE_PLUS_1_MB_PER_SEC};
 	TWI_init(&twi_config_1);
+	/* run the bus at the fastest rate the EEPROM really answers */
+	TWI_probeMaxBitRate(EEPROM_DEVICE_ADDRESS, FAST_MODE_PLUS_1_MB_PER_SEC);
+	/* time base of the audit log and of the hash entropy */
+	Tick_init();
+	/* device key of the hashes from the link key, entropy from the kept pool and the ADC noise */
+	PinHash_init();
+	/* find the newest stored password, if any */
+	if(CredStore_init() == SUCCESS)
+	{
+		g_passwordSatate=THERE_IS_PASSWORD;
+	}
+	/* load the users and build their index */
+	UserTable_init();
+	/* wrong password backoff, a reset does not end a lockout */
+	Lockout_init();
+	/* the first open door challenge is precomputed while idle */
+	Challenge_init();
 	//initiation
 	Buzzer_init();
 	DcMotor_Init();
+	/* end switches of the door travel */
+	Door_init();
+	/* find the end of the audit log and record the boot */
+	AuditLog_init();
+	/* lifetime counters, saved every few events or minutes instead of on every event */
+	Counters_ConfigType counters_config={COUNTERS_FLUSH_EVENTS,COUNTERS_FLUSH_INTERVAL_MS};
+	Counters_init(&counters_config);
+	/* the PIN check and a link frame of this build against their cycle budgets while Timer1 is free,
+	   an overrun is audited */
+	g_pinHashCycles=PinHash_measure();
+	if(g_pinHashCycles > PIN_HASH_BUDGET_CYCLES)
+	{
+		AuditLog_record(AUDIT_EVENT_OVER_BUDGET,AUDIT_BUDGET_PIN_HASH);
+	}
+	g_linkFrameCycles=Link_measureFrame();
+	if(g_linkFrameCycles > LINK_FRAME_BUDGET_CYCLES)
+	{
+		AuditLog_record(AUDIT_EVENT_OVER_BUDGET,AUDIT_BUDGET_LINK_FRAME);
+	}
+	/* an abnormal reset is audited: cause bits and the late task in the user byte */
+	if(Watchdog_getResetCause() & (WATCHDOG_CAUSE_WATCHDOG | WATCHDOG_CAUSE_BROWN_OUT))
+	{
+		AuditLog_record(AUDIT_EVENT_RESET_CAUSE,(uint8)(Watchdog_getResetCause() | (Watchdog_getExpiredTask() << 4)));
+	}
+	/* from now a hang anywhere resets the ECU: the audit flush (task 0) and the counters save (task 1)
+	   registered themselves with their own deadlines, the main loop is task 2 */
+	g_mainTask=Watchdog_register(MAIN_LOOP_DEADLINE_MS);
+	Watchdog_start();
 
 
 	while(1)
 	{
-		/* blocking and wait for order from HMI_ECU */
-		g_currentMode = UART_recieveByte();
+		Watchdog_checkIn(g_mainTask);
+		/* write the staged audit events while no order is waiting */
+		AuditLog_task();
+		Counters_task();
+		Challenge_task();
+		/* a rate that gives receive errors is left for the safe one */
+		Baud_task();
+		/* nothing to do: sleep until the tick, a byte from HMI_ECU or another interrupt */
+		cli();
+		if(!UART_isByteReceived() && !Challenge_isBusy())
+		{
+			Idle_sleep();
+		}
+		sei();
+		/* order from HMI_ECU */
+		if(UART_recieveByteTimeout(&g_currentMode,0) == ERROR)
+		{
+			continue;
+		}
+		Watchdog_trace(g_currentMode);
 
 		switch(g_currentMode)
 		{
 
+		case BAUD_HELLO:
+			/*HMI_ECU asks for the fastest rate both sides run*/
+			Baud_answer();
+			break;
+
 		case THERE_IS_PASSWORD_OR_NO:
+			if(g_isResetReportPending)
+			{
+				/*the cause of the last reset and the task that hung, before the answer*/
+				UART_sendByte(RESET_REPORT);
+				UART_sendByte(Watchdog_getResetCause());
+				UART_sendByte(Watchdog_getExpiredTask());
+				g_isResetReportPending=FALSE;
+			}
 			UART_sendByte(g_passwordSatate);
 			break;
 
 		case SENDING_FIRST_PASSWORD:
-			UART_recieveArrayOfByte(password,MAX_DIGITS);
+			g_isFirstPasswordValid=(Link_receive(password,MAX_DIGITS,RECEIVE_TIMEOUT_MS) == SUCCESS);
 			break;
 
 		case SENDING_SECOND_PASSWORD:
-			UART_recieveArrayOfByte(password_check,MAX_DIGITS);
+			g_linkStatus=Link_receive(password_check,MAX_DIGITS,RECEIVE_TIMEOUT_MS);
 			//check the two password and then send the result to HMI_ECU
-			if(checkTwoArray(password,password_check,MAX_DIGITS))
+			if((g_linkStatus == SUCCESS) && g_isFirstPasswordValid && checkTwoArray(password,password_check,MAX_DIGITS))
 			{
 				UART_sendByte(MATCHED);
 				savePasswordToEEPROM();
 				g_passwordSatate=THERE_IS_PASSWORD;
+				Buzzer_play(BUZZER_PATTERN_SUCCESS);
+				Challenge_invalidate();
+				AuditLog_record(AUDIT_EVENT_PASSWORD_CHANGED,AUDIT_USER_SYSTEM);
 			}
 			else
 			{
@@ -148,75 +431,125 @@ int main(void)
 			break;
 
 		case OPEN_DOOR_MODE:
-			/*Control_ECU receive password from HMI_ECU  */
-			UART_recieveArrayOfByte(password,MAX_DIGITS);
-			/*Read PASSWORD From EEPROM*/
-			readPasswordFromEEPROM(password_check);
-			if(checkTwoArray(password,password_check,MAX_DIGITS))
+			/*a locked out system answers at once with the time left*/
+			if(Lockout_getRetryAfter() != 0)
 			{
-				UART_sendByte(MATCHED);
-				/*rotates motor for 15-seconds CW and display a message on the screen"Door is Unlocking"*/
-				DcMotor_Rotate(CW,MAX_SPEED_FOR_DC_MOTER);
-				/* waiting 15 seconds for the door to open  */
-				DelaySecondTimer1(TIME_FOR_UNLOKING_THE_DOOR);
-				/* Stop the motor */
-				DcMotor_Rotate(STOP, 0);
-				/* waiting for 3 seconds the hold period of the door */
-				DelaySecondTimer1(DOOR_HOLD_TIME);
-				/* turn on motor at max speed with anti clock wise direction */
-				DcMotor_Rotate(A_CW,MAX_SPEED_FOR_DC_MOTER);
-				/* waiting 15 seconds for the door to lock  */
-				DelaySecondTimer1(TIME_FOR_UNLOKING_THE_DOOR);
-				/* stop the motor */
-				DcMotor_Rotate(STOP, 0);
+				sendLockedOut();
+				break;
 			}
-			else
+			UART_sendByte(NOT_LOCKED_OUT);
+			/*the tag of the PIN gives the one user whose salt is sent with the precomputed nonce,
+			  the HMI answers with MACs of the password*/
+			g_linkStatus=Link_receive(g_tag,CHALLENGE_TAG_SIZE,RECEIVE_TIMEOUT_MS);
+			Challenge_send(g_tag[0] | ((uint16)g_tag[1] << 8));
+			if(Link_receive(g_response,CHALLENGE_RESPONSE_SIZE,RECEIVE_TIMEOUT_MS) == ERROR)
 			{
-				/*send to HMI_ECU that passwords are mismatched*/
-				UART_sendByte(MISMATCHED);
-				/* wait HMI_ECU to take action to Turn on or Turn off the Buzzer */
-				g_commandRececived=UART_recieveByte();
-				if (g_commandRececived== BUZZER_ON)
+				g_linkStatus=ERROR;
+			}
+			/*only compare the answer with the MACs expected for the system password and that user,
+			  the nonce is used up even by a bad frame*/
+			if(checkResponse(g_response) && (g_linkStatus == SUCCESS))
+			{
+				UART_sendByte(MATCHED);
+				Lockout_recordSuccess();
+				Buzzer_play(BUZZER_PATTERN_SUCCESS);
+				AuditLog_record(AUDIT_EVENT_DOOR_OPENED,g_lastUser);
+				/*rotates motor CW until the open switch, the HMI displays "Door is Unlocking"*/
+				if(moveDoor(DOOR_OPEN) == DOOR_AT_END)
 				{
-					/* turn on the buzzer */
-					Buzzer_on();
-					/* waiting for 1 minute */
-					DelaySecondTimer1(BUZZER_ON_PERIOD);
-					/* turn off the buzzer */
-					Buzzer_off();
+					/* waiting for 3 seconds the hold period of the door */
+					DelaySecondTimer1(DOOR_HOLD_TIME);
 				}
+				/* rotates motor anti clock wise until the closed switch, also after a jam */
+				moveDoor(DOOR_CLOSE);
+				Counters_add(COUNTER_DOOR_CYCLES,1);
+			}
+			else
+			{
+				/*send to HMI_ECU that passwords are mismatched and the time before the next try*/
+				rejectPassword();
 			}
 			break;
 
 		case CHANGE_PASSWORD:
 			/*Control_ECU receive password from HMI_ECU  */
-			UART_recieveArrayOfByte(password,MAX_DIGITS);
-			/*Read PASSWORD From EEPROM*/
-			readPasswordFromEEPROM(password_check);
-			/*checking between them*/
-			if(checkTwoArray(password,password_check,MAX_DIGITS))
+			g_linkStatus=Link_receive(password,MAX_DIGITS,RECEIVE_TIMEOUT_MS);
+			if(Lockout_getRetryAfter() != 0)
+			{
+				sendLockedOut();
+			}
+			/*only the system password or an admin user can change it*/
+			else if((g_linkStatus == SUCCESS) && checkPassword(password,TRUE))
 			{
 				UART_sendByte(MATCHED);
+				Lockout_recordSuccess();
 				//now there is no password for system
 				g_passwordSatate=THERE_IS_NO_PASSWORD;
 			}
 			else
 			{
-				/*send to HMI_ECU that passwords are mismatched*/
+				/*send to HMI_ECU that passwords are mismatched and the time before the next try*/
+				rejectPassword();
+			}
+			break;
+
+		case ADD_USER:
+			/*receive the admin password, then the new user PIN and its role in one frame*/
+			g_linkStatus=Link_receive(password,MAX_DIGITS,RECEIVE_TIMEOUT_MS);
+			if(Link_receive(user_pin,USER_FRAME_SIZE,RECEIVE_TIMEOUT_MS) == ERROR)
+			{
+				g_linkStatus=ERROR;
+			}
+			if(checkAdmin() && (UserTable_add(user_pin,
+					(user_pin[USER_FRAME_ROLE_INDEX] == USER_ROLE_ADMIN) ? USER_ROLE_ADMIN : USER_ROLE_USER) != USER_NOT_FOUND))
+			{
+				UART_sendByte(MATCHED);
+				AuditLog_record(AUDIT_EVENT_USER_ADDED,g_lastUser);
+				Challenge_invalidate();
+			}
+			else
+			{
 				UART_sendByte(MISMATCHED);
-				/* wait HMI_ECU to take action to Turn on or Turn off the Buzzer */
-				g_commandRececived=UART_recieveByte();
-				if (g_commandRececived== BUZZER_ON)
-				{
-					/* turn on the buzzer */
-					Buzzer_on();
-					/* waiting for 1 minute */
-					DelaySecondTimer1(BUZZER_ON_PERIOD);
-					/* turn off the buzzer */
-					Buzzer_off();
-				}
 			}
 			break;
+
+		case REMOVE_USER:
+			/*receive the admin password and the PIN of the user to remove*/
+			g_linkStatus=Link_receive(password,MAX_DIGITS,RECEIVE_TIMEOUT_MS);
+			if(Link_receive(user_pin,MAX_DIGITS,RECEIVE_TIMEOUT_MS) == ERROR)
+			{
+				g_linkStatus=ERROR;
+			}
+			if(checkAdmin() && (UserTable_remove(UserTable_find(user_pin,&g_user)) == SUCCESS))
+			{
+				UART_sendByte(MATCHED);
+				AuditLog_record(AUDIT_EVENT_USER_REMOVED,g_lastUser);
+				Challenge_invalidate();
+			}
+			else
+			{
+				UART_sendByte(MISMATCHED);
+			}
+			break;
+
+		case EXPORT_AUDIT_LOG:
+			/*only an admin reads the access history, the pages go as encrypted frames*/
+			g_linkStatus=Link_receive(password,MAX_DIGITS,RECEIVE_TIMEOUT_MS);
+			if(checkAdmin())
+			{
+				UART_sendByte(MATCHED);
+				AuditLog_export(Link_send);
+			}
+			else
+			{
+				UART_sendByte(MISMATCHED);
+			}
+			break;
+
+		default:
+			/*a byte out of any order: drop the rest of the broken exchange*/
+			UART_resync();
+			break;
 		}
 	}
 }
@@ -5,36 +5,96 @@
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
 ../Control_ECU.c \
+../adc.c \
+../audit_log.c \
+../baud.c \
 ../buzzer.c \
+../chacha.c \
+../challenge.c \
+../counters.c \
+../cred_store.c \
+../cycles.c \
 ../dc_motor.c \
+../door.c \
 ../external_eeprom.c \
 ../gpio.c \
+../idle.c \
+../internal_eeprom.c \
+../link.c \
+../lockout.c \
+../pin_hash.c \
 ../pwm.c \
+../siphash.c \
+../storage.c \
+../tick.c \
 ../timer1.c \
+../timer2.c \
 ../twi.c \
-../uart.c 
+../uart.c \
+../user_table.c \
+../watchdog.c 
 
 OBJS += \
 ./Control_ECU.o \
+./adc.o \
+./audit_log.o \
+./baud.o \
 ./buzzer.o \
+./chacha.o \
+./challenge.o \
+./counters.o \
+./cred_store.o \
+./cycles.o \
 ./dc_motor.o \
+./door.o \
 ./external_eeprom.o \
 ./gpio.o \
+./idle.o \
+./internal_eeprom.o \
+./link.o \
+./lockout.o \
+./pin_hash.o \
 ./pwm.o \
+./siphash.o \
+./storage.o \
+./tick.o \
 ./timer1.o \
+./timer2.o \
 ./twi.o \
-./uart.o 
+./uart.o \
+./user_table.o \
+./watchdog.o 
 
 C_DEPS += \
 ./Control_ECU.d \
+./adc.d \
+./audit_log.d \
+./baud.d \
 ./buzzer.d \
+./chacha.d \
+./challenge.d \
+./counters.d \
+./cred_store.d \
+./cycles.d \
 ./dc_motor.d \
+./door.d \
 ./external_eeprom.d \
 ./gpio.d \
+./idle.d \
+./internal_eeprom.d \
+./link.d \
+./lockout.d \
+./pin_hash.d \
 ./pwm.d \
+./siphash.d \
+./storage.d \
+./tick.d \
 ./timer1.d \
+./timer2.d \
 ./twi.d \
-./uart.d 
+./uart.d \
+./user_table.d \
+./watchdog.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
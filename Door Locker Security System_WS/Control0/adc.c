@@ -0,0 +1,186 @@
+/*
+ * adc.c
+ *
+ *      Author: Ayman_Mostafa
+ */
+
+#include "avr/io.h"
+#include "adc.h"
+#include "common_macros.h"
+#include <avr/interrupt.h>
+#if ADC_TEST_INPUT
+#include "tick.h"
+#endif
+
+static volatile uint16 g_ring[ADC_RING_SIZE];
+static volatile uint8 g_head = 0;
+static volatile uint8 g_count = 0;
+static volatile uint16 g_overruns = 0;
+/* ADPS bits of the configuration, the converter only runs between ADC_start and ADC_stop */
+static uint8 g_prescaler = ADC_PRESCALE_128;
+#if ADC_TEST_INPUT
+/* the waveform only runs between ADC_start and ADC_stop, as the converter */
+static volatile boolean g_isRunning = FALSE;
+static volatile uint16 g_testMs = 0;
+#endif
+
+/*******************************************************************************
+ *                      Private Functions                                  *
+ *******************************************************************************/
+
+/* store a sample, called with the interrupts masked */
+static void ADC_store(uint16 sample)
+{
+	if(g_count == ADC_RING_SIZE)
+	{
+		/* the newest sample is dropped, the consumer reads too slowly */
+		g_overruns++;
+		return;
+	}
+	g_ring[(g_head + g_count) & (ADC_RING_SIZE - 1)] = sample;
+	g_count++;
+}
+
+#if ADC_TEST_INPUT
+/* sample of the ADC_TEST_PROFILE waveform at this time since ADC_start, the sample number gives the ripple */
+static uint16 ADC_testWaveform(uint16 ms,uint8 sample)
+{
+	uint16 level = ADC_TEST_RUN_SAMPLE;
+
+	if(ms < ADC_TEST_INRUSH_MS)
+	{
+		/* the inrush falls linearly to the run current */
+		level += (uint16)(((uint32)(ADC_TEST_INRUSH_PEAK - ADC_TEST_RUN_SAMPLE) * (ADC_TEST_INRUSH_MS - ms)) / ADC_TEST_INRUSH_MS);
+	}
+#if (ADC_TEST_PROFILE == ADC_TEST_STALL)
+	else if(ms >= ADC_TEST_STALL_AT_MS)
+	{
+		level = ADC_TEST_STALL_SAMPLE;
+	}
+#endif
+	/* ripple of the PWM, one sample up, the next one down */
+	return (sample & 1) ? (level - ADC_TEST_RIPPLE) : (level + ADC_TEST_RIPPLE);
+}
+
+/* the conversions of the last millisecond, executed each 1ms from the tick interrupt */
+static void ADC_testTick(void)
+{
+	if(!g_isRunning)
+	{
+		return;
+	}
+	for(uint8 i = 0; i < ADC_TEST_SAMPLES_PER_MS; i++)
+	{
+		ADC_injectSample(ADC_testWaveform(g_testMs, i));
+	}
+	if(g_testMs != 0xFFFF)
+	{
+		g_testMs++;
+	}
+}
+#endif
+
+/*******************************************************************************
+ *                              ISR                                    *
+ *******************************************************************************/
+
+/* end of a conversion, the next one is already started by the free running mode */
+ISR(ADC_vect)
+{
+#if !ADC_TEST_INPUT
+	ADC_store(ADCW);
+#endif
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/* Description
+⮚ Function to initialize the ADC driver in free running mode on one channel.
+⮚ The converter stays off until ADC_start.*/
+void ADC_init(const ADC_ConfigType * Config_Ptr)
+{
+	/* ADMUX: reference voltage, right adjusted result, channel 0..7 */
+	ADMUX = (uint8)((Config_Ptr->ref_volt << REFS0) | (Config_Ptr->channel & 0x07));
+	/* free running mode ADTS2:0=000 */
+	SFIOR &= 0x1F;
+	g_prescaler = Config_Ptr->prescaler & 0x07;
+	ADC_stop();
+#if ADC_TEST_INPUT
+	/* added before the consumers on the tick, the samples are there when they read */
+	Tick_addCallBack(ADC_testTick);
+#endif
+}
+
+/* Description
+⮚ Start the free running conversions, each one (13 ADC clocks) is stored by the
+  interrupt in a ring buffer, with F_CPU/128 at 8MHz that is one sample each 208us.*/
+void ADC_start(void)
+{
+#if !ADC_TEST_INPUT
+	/* ADEN=1 enable, ADATE=1 auto trigger, ADIE=1 interrupt, ADSC=1 start the first conversion */
+	ADCSRA = (1<<ADEN) | (1<<ADATE) | (1<<ADIE) | (1<<ADSC) | g_prescaler;
+#else
+	g_testMs = 0;
+	g_isRunning = TRUE;
+#endif
+}
+
+/* Description
+⮚ Stop the conversions and switch the converter off: no more interrupts and
+  no analog supply current. It is safe to call from an ISR.*/
+void ADC_stop(void)
+{
+	/* ADEN=0 ends a running conversion, ADIF is cleared by writing it to 1 */
+	ADCSRA = (1<<ADIF) | g_prescaler;
+#if ADC_TEST_INPUT
+	g_isRunning = FALSE;
+#endif
+}
+
+/* Description
+⮚ Take the oldest sample of the ring buffer, return ERROR if it is empty.
+  It is safe to call from an ISR.*/
+uint8 ADC_getSample(uint16 *sample)
+{
+	uint8 status = ERROR;
+	uint8 sreg = SREG;
+
+	cli();
+	if(g_count != 0)
+	{
+		*sample = g_ring[g_head];
+		g_head = (g_head + 1) & (ADC_RING_SIZE - 1);
+		g_count--;
+		status = SUCCESS;
+	}
+	SREG = sreg;
+	return status;
+}
+
+/* Description
+⮚ Return the number of samples lost because the ring buffer was full.*/
+uint16 ADC_getOverruns(void)
+{
+	uint16 overruns;
+	uint8 sreg = SREG;
+
+	cli();
+	overruns = g_overruns;
+	SREG = sreg;
+	return overruns;
+}
+
+#if ADC_TEST_INPUT
+/* Description
+⮚ Store a synthetic sample in the ring buffer as if it was converted.*/
+void ADC_injectSample(uint16 sample)
+{
+	uint8 sreg = SREG;
+
+	cli();
+	ADC_store(sample);
+	SREG = sreg;
+}
+#endif
@@ -0,0 +1,103 @@
+/*
+ * adc.h
+ *
+ *      Author: Ayman_Mostafa
+ */
+
+#ifndef ADC_H_
+#define ADC_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                       definitions                                    *
+ *******************************************************************************/
+#ifndef SUCCESS
+#define ERROR 0
+#define SUCCESS 1
+#endif
+
+#define ADC_MAXIMUM_VALUE           1023
+
+/* Samples kept between two reads of the consumer, must be a power of 2 */
+#define ADC_RING_SIZE               16
+
+/*
+ * 1 to take the samples from ADC_injectSample instead of the converter,
+ * to test the consumers with synthetic waveforms
+ */
+#define ADC_TEST_INPUT              0
+
+#if ADC_TEST_INPUT
+/*
+ * Motor current waveform made on the 1ms tick from ADC_start, in ADC counts:
+ * an inrush falling from ADC_TEST_INRUSH_PEAK to the run current in ADC_TEST_INRUSH_MS,
+ * inside the stall blanking of the motor, then the run current with the PWM ripple.
+ * ADC_TEST_STALL adds a stall at ADC_TEST_STALL_AT_MS that must cut the motor,
+ * ADC_TEST_RUN must travel to the end switch without being cut.
+ */
+#define ADC_TEST_RUN                0
+#define ADC_TEST_STALL              1
+#define ADC_TEST_PROFILE            ADC_TEST_STALL
+
+#define ADC_TEST_SAMPLES_PER_MS     4
+#define ADC_TEST_INRUSH_PEAK        300
+#define ADC_TEST_INRUSH_MS          60
+#define ADC_TEST_RUN_SAMPLE         40
+#define ADC_TEST_RIPPLE             8
+#define ADC_TEST_STALL_SAMPLE       250
+#define ADC_TEST_STALL_AT_MS        400
+#endif
+
+typedef enum
+{
+	ADC_AREF,ADC_AVCC,ADC_INTERNAL_2_56=3
+}ADC_ReferenceVoltage;
+
+typedef enum
+{
+	ADC_PRESCALE_2=1,ADC_PRESCALE_4,ADC_PRESCALE_8,ADC_PRESCALE_16,ADC_PRESCALE_32,
+	ADC_PRESCALE_64,ADC_PRESCALE_128
+}ADC_Prescaler;
+
+typedef struct {
+ ADC_ReferenceVoltage ref_volt;
+ ADC_Prescaler prescaler;
+ uint8 channel;
+} ADC_ConfigType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/* Description
+⮚ Function to initialize the ADC driver in free running mode on one channel.
+⮚ The converter stays off until ADC_start.*/
+void ADC_init(const ADC_ConfigType * Config_Ptr);
+
+/* Description
+⮚ Start the free running conversions, each one (13 ADC clocks) is stored by the
+  interrupt in a ring buffer, with F_CPU/128 at 8MHz that is one sample each 208us.*/
+void ADC_start(void);
+
+/* Description
+⮚ Stop the conversions and switch the converter off: no more interrupts and
+  no analog supply current. It is safe to call from an ISR.*/
+void ADC_stop(void);
+
+/* Description
+⮚ Take the oldest sample of the ring buffer, return ERROR if it is empty.
+  It is safe to call from an ISR.*/
+uint8 ADC_getSample(uint16 *sample);
+
+/* Description
+⮚ Return the number of samples lost because the ring buffer was full.*/
+uint16 ADC_getOverruns(void);
+
+#if ADC_TEST_INPUT
+/* Description
+⮚ Store a synthetic sample in the ring buffer as if it was converted.*/
+void ADC_injectSample(uint16 sample);
+#endif
+
+#endif /* ADC_H_ */
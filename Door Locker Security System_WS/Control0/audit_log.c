@@ -0,0 +1,328 @@
+ /******************************************************************************
+ *
+ * Module: Audit Log
+ *
+ * File Name: audit_log.c
+ *
+ * Description: Source file for the access audit log in the External EEPROM
+ *
+ *******************************************************************************/
+
+#include "audit_log.h"
+#include "storage.h"
+#include "tick.h"
+#include "watchdog.h"
+#include <util/crc16.h>
+
+/* Two RAM pages: one receives the events while the other one waits for its page write */
+static AuditLog_PageType g_pages[2];
+static uint8 g_fillPage = 0;
+static boolean g_flushPending = FALSE;
+static boolean g_flushRunning = FALSE;
+static volatile TWI_TransferStatus g_flushResult = TWI_TRANSFER_IDLE;
+static uint32 g_flushStartMs = 0;
+static uint8 g_watchdogTask = WATCHDOG_NO_TASK;
+
+/* Next page of the ring */
+static uint8 g_nextSlot = 0;
+static uint16 g_nextSequence = 0;
+static boolean g_wrapped = FALSE;
+
+static uint32 g_lastEventSecond = 0;
+static uint16 g_dropped = 0;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void AuditLog_stage(uint8 code,uint16 delta,uint8 user);
+static void AuditLog_swapPages(void);
+static void AuditLog_flushDone(TWI_TransferStatus status);
+static uint16 AuditLog_slotOffset(uint8 slot);
+static boolean AuditLog_readHeader(uint8 slot,uint16 *sequence_Ptr);
+static uint8 AuditLog_crc(const AuditLog_PageType *page_Ptr);
+static void AuditLog_exportRun(uint8 slot,uint8 pages,void(*a_send)(const uint8 *data,uint8 length));
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void AuditLog_init(void)
+{
+	uint16 firstSequence;
+	uint16 sequence;
+	uint8 low = 0;
+	uint8 high = AUDIT_LOG_PAGES - 1;
+	uint8 mid;
+
+	g_nextSlot = 0;
+	g_nextSequence = 0;
+	g_wrapped = FALSE;
+	g_fillPage = 1;
+	AuditLog_swapPages();
+	g_flushPending = FALSE;
+
+	/* Pages written during the current lap hold firstSequence + slot: binary search the last one */
+	if(AuditLog_readHeader(0, &firstSequence))
+	{
+		while(low < high)
+		{
+			mid = (uint8)((low + high + 1) / 2);
+			if(AuditLog_readHeader(mid, &sequence) && ((uint16)(sequence - firstSequence) == mid))
+			{
+				low = mid;
+			}
+			else
+			{
+				high = mid - 1;
+			}
+		}
+		g_nextSlot = (uint8)((low + 1) % AUDIT_LOG_PAGES);
+		g_nextSequence = firstSequence + low + 1;
+		/* The page after the newest one is written if the ring already went around once */
+		g_wrapped = AuditLog_readHeader(g_nextSlot, &sequence);
+	}
+
+	g_lastEventSecond = Tick_getSeconds();
+	g_watchdogTask = Watchdog_register(AUDIT_LOG_FLUSH_DEADLINE_MS);
+	AuditLog_record(AUDIT_EVENT_BOOT, AUDIT_USER_NONE);
+}
+
+void AuditLog_record(AuditLog_Event event, uint8 user)
+{
+	uint32 now = Tick_getSeconds();
+	uint32 delta = now - g_lastEventSecond;
+	uint32 gap;
+
+	g_lastEventSecond = now;
+
+	/* Gaps too long for the 12-bit delta are stored first as time gap events */
+	while(delta > AUDIT_LOG_MAX_DELTA)
+	{
+		gap = (delta > AUDIT_LOG_MAX_GAP) ? AUDIT_LOG_MAX_GAP : delta;
+		AuditLog_stage(AUDIT_EVENT_TIME_GAP, (uint16)(gap & AUDIT_LOG_MAX_DELTA), (uint8)(gap >> 12));
+		delta -= gap;
+	}
+	AuditLog_stage(event, (uint16)delta, user);
+}
+
+void AuditLog_task(void)
+{
+	AuditLog_PageType *page_Ptr = &g_pages[1 - g_fillPage];
+
+	if(!g_flushPending)
+	{
+		Watchdog_checkIn(g_watchdogTask);
+		return;
+	}
+
+	if(g_flushRunning)
+	{
+		if(g_flushResult == TWI_TRANSFER_BUSY)
+		{
+			/* A stuck bus must not keep the page forever */
+			if((Tick_getMs() - g_flushStartMs) > AUDIT_LOG_FLUSH_TIMEOUT_MS)
+			{
+				TWI_abortTransfer();
+			}
+			return;
+		}
+		g_flushRunning = FALSE;
+		if(g_flushResult == TWI_TRANSFER_DONE)
+		{
+			g_nextSlot = (uint8)((g_nextSlot + 1) % AUDIT_LOG_PAGES);
+			if(g_nextSlot == 0)
+			{
+				g_wrapped = TRUE;
+			}
+			g_nextSequence++;
+			g_flushPending = FALSE;
+			Watchdog_checkIn(g_watchdogTask);
+			/* The other page may have filled up during the write */
+			if(g_pages[g_fillPage].count == AUDIT_LOG_EVENTS_PER_PAGE)
+			{
+				AuditLog_swapPages();
+			}
+			return;
+		}
+		/* NACK while the memory finishes another write cycle, or error: write it again */
+	}
+
+	if(Storage_isBusy(STORAGE_AUDIT_LOG))
+	{
+		return;
+	}
+
+	page_Ptr->sequence = g_nextSequence;
+	page_Ptr->crc = AuditLog_crc(page_Ptr);
+	g_flushResult = TWI_TRANSFER_BUSY;
+	if(Storage_writeAsync(STORAGE_AUDIT_LOG, AuditLog_slotOffset(g_nextSlot), (const uint8 *)page_Ptr, AUDIT_LOG_PAGE_SIZE, AuditLog_flushDone) == SUCCESS)
+	{
+		g_flushRunning = TRUE;
+		g_flushStartMs = Tick_getMs();
+	}
+}
+
+void AuditLog_export(void(*a_send)(const uint8 *data, uint8 length))
+{
+	uint16 pages;
+	uint8 header[2];
+
+	/* Let a running page write finish so it is exported from the EEPROM */
+	while(g_flushRunning)
+	{
+		TWI_waitTransfer();
+		AuditLog_task();
+	}
+
+	pages = g_wrapped ? AUDIT_LOG_PAGES : g_nextSlot;
+	pages += (g_flushPending ? 1 : 0) + ((g_pages[g_fillPage].count != 0) ? 1 : 0);
+	header[0] = (uint8)pages;
+	header[1] = (uint8)(pages >> 8);
+	(*a_send)(header, sizeof(header));
+
+	/* Oldest page first: two sequential runs when the ring went around */
+	if(g_wrapped)
+	{
+		AuditLog_exportRun(g_nextSlot, AUDIT_LOG_PAGES - g_nextSlot, a_send);
+	}
+	AuditLog_exportRun(0, g_nextSlot, a_send);
+
+	/* Pages still in RAM, numbered as they will be written */
+	if(g_flushPending)
+	{
+		g_pages[1 - g_fillPage].sequence = g_nextSequence;
+		g_pages[1 - g_fillPage].crc = AuditLog_crc(&g_pages[1 - g_fillPage]);
+		(*a_send)((const uint8 *)&g_pages[1 - g_fillPage], AUDIT_LOG_PAGE_SIZE);
+	}
+	if(g_pages[g_fillPage].count != 0)
+	{
+		g_pages[g_fillPage].sequence = g_nextSequence + (g_flushPending ? 1 : 0);
+		g_pages[g_fillPage].crc = AuditLog_crc(&g_pages[g_fillPage]);
+		(*a_send)((const uint8 *)&g_pages[g_fillPage], AUDIT_LOG_PAGE_SIZE);
+	}
+}
+
+uint16 AuditLog_getDropped(void)
+{
+	return g_dropped;
+}
+
+/*
+ * Description :
+ * Append one event to the RAM page, hand the page to the flush task when it is full.
+ */
+static void AuditLog_stage(uint8 code, uint16 delta, uint8 user)
+{
+	AuditLog_PageType *page_Ptr = &g_pages[g_fillPage];
+	uint8 *event_Ptr;
+
+	if(page_Ptr->count >= AUDIT_LOG_EVENTS_PER_PAGE)
+	{
+		/* Full page and the other one still not written */
+		g_dropped++;
+		return;
+	}
+
+	event_Ptr = &page_Ptr->events[page_Ptr->count * AUDIT_LOG_EVENT_SIZE];
+	event_Ptr[0] = (uint8)((code << 4) | (delta >> 8));
+	event_Ptr[1] = (uint8)delta;
+	event_Ptr[2] = user;
+	page_Ptr->count++;
+
+	if((page_Ptr->count == AUDIT_LOG_EVENTS_PER_PAGE) && (!g_flushPending))
+	{
+		AuditLog_swapPages();
+	}
+}
+
+/*
+ * Description :
+ * Hand the full page to the flush task and start filling the other (empty) one.
+ */
+static void AuditLog_swapPages(void)
+{
+	g_flushPending = TRUE;
+	g_fillPage = 1 - g_fillPage;
+	g_pages[g_fillPage].count = 0;
+	for(uint8 i = 0; i < sizeof(g_pages[g_fillPage].events); i++)
+	{
+		g_pages[g_fillPage].events[i] = 0xFF;
+	}
+}
+
+/*
+ * Description :
+ * Call back of the page write, called from the TWI interrupt.
+ */
+static void AuditLog_flushDone(TWI_TransferStatus status)
+{
+	g_flushResult = status;
+}
+
+static uint16 AuditLog_slotOffset(uint8 slot)
+{
+	return ((uint16)slot * AUDIT_LOG_PAGE_SIZE);
+}
+
+/*
+ * Description :
+ * Read the sequence number and the count of a page, return FALSE if it was never written.
+ */
+static boolean AuditLog_readHeader(uint8 slot, uint16 *sequence_Ptr)
+{
+	uint8 header[3];
+
+	if(Storage_read(STORAGE_AUDIT_LOG, AuditLog_slotOffset(slot), header, sizeof(header)) == ERROR)
+	{
+		return FALSE;
+	}
+	*sequence_Ptr = header[0] | ((uint16)header[1] << 8);
+	return (header[2] != AUDIT_LOG_ERASED);
+}
+
+/*
+ * Description :
+ * CRC-8 (polynomial 0x07) of the page without its crc byte.
+ */
+static uint8 AuditLog_crc(const AuditLog_PageType *page_Ptr)
+{
+	const uint8 *bytes = (const uint8 *)page_Ptr;
+	uint8 crc = 0;
+
+	for(uint8 i = 0; i < (AUDIT_LOG_PAGE_SIZE - 1); i++)
+	{
+		crc = _crc8_ccitt_update(crc, bytes[i]);
+	}
+	return crc;
+}
+
+/*
+ * Description :
+ * Send consecutive pages of the ring, read AUDIT_LOG_EXPORT_CHUNK_PAGES at a time.
+ */
+static void AuditLog_exportRun(uint8 slot, uint8 pages, void(*a_send)(const uint8 *data, uint8 length))
+{
+	uint8 buffer[AUDIT_LOG_EXPORT_CHUNK_PAGES * AUDIT_LOG_PAGE_SIZE];
+	uint8 chunk;
+
+	while(pages > 0)
+	{
+		chunk = (pages > AUDIT_LOG_EXPORT_CHUNK_PAGES) ? AUDIT_LOG_EXPORT_CHUNK_PAGES : pages;
+		if(Storage_read(STORAGE_AUDIT_LOG, AuditLog_slotOffset(slot), buffer, (uint16)chunk * AUDIT_LOG_PAGE_SIZE) == ERROR)
+		{
+			/* Keep the stream length: an unreadable page is sent erased */
+			for(uint8 i = 0; i < sizeof(buffer); i++)
+			{
+				buffer[i] = 0xFF;
+			}
+		}
+		/* One call per page, a page fits one frame of the link */
+		for(uint8 i = 0; i < chunk; i++)
+		{
+			(*a_send)(&buffer[i * AUDIT_LOG_PAGE_SIZE], AUDIT_LOG_PAGE_SIZE);
+		}
+		slot += chunk;
+		pages -= chunk;
+	}
+}
@@ -0,0 +1,116 @@
+ /******************************************************************************
+ *
+ * Module: Audit Log
+ *
+ * File Name: audit_log.h
+ *
+ * Description: Header file for the access audit log in the External EEPROM
+ *
+ *******************************************************************************/
+
+#ifndef AUDIT_LOG_H_
+#define AUDIT_LOG_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/* Ring of pages filling the STORAGE_AUDIT_LOG record */
+#define AUDIT_LOG_PAGES              48
+#define AUDIT_LOG_PAGE_SIZE          16
+
+/*
+ * An event is 3 bytes: [code:4 | delta:12] [delta low byte] [user]
+ * delta is the number of seconds since the previous event, longer gaps are
+ * stored first as AUDIT_EVENT_TIME_GAP events holding a 20-bit delta (user byte = high bits)
+ */
+#define AUDIT_LOG_EVENT_SIZE         3
+#define AUDIT_LOG_EVENTS_PER_PAGE    4
+#define AUDIT_LOG_MAX_DELTA          0x0FFF
+#define AUDIT_LOG_MAX_GAP            0xFFFFFUL
+
+/* count byte of a page never written */
+#define AUDIT_LOG_ERASED             0xFF
+
+/* a page flush not finished after this time is aborted and retried */
+#define AUDIT_LOG_FLUSH_TIMEOUT_MS   50
+
+/*
+ * the flush is a watchdog task of its own: a staged page still not written after this
+ * time, about 20 aborted tries, resets the ECU and its TWI
+ */
+#define AUDIT_LOG_FLUSH_DEADLINE_MS  1000UL
+
+/* pages read from the EEPROM by one sequential read during the export */
+#define AUDIT_LOG_EXPORT_CHUNK_PAGES 2
+
+/* user byte of events not done by a user of the table */
+#define AUDIT_USER_SYSTEM            0xFE
+#define AUDIT_USER_NONE              0xFF
+
+/* user byte of AUDIT_EVENT_OVER_BUDGET: the path measured over its cycle budget at boot */
+#define AUDIT_BUDGET_PIN_HASH        0
+#define AUDIT_BUDGET_LINK_FRAME      1
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef enum
+{
+	AUDIT_EVENT_BOOT,AUDIT_EVENT_DOOR_OPENED,AUDIT_EVENT_WRONG_PIN,AUDIT_EVENT_ALARM,
+	AUDIT_EVENT_PASSWORD_CHANGED,AUDIT_EVENT_USER_ADDED,AUDIT_EVENT_USER_REMOVED,
+	AUDIT_EVENT_DOOR_JAMMED,AUDIT_EVENT_RESET_CAUSE,AUDIT_EVENT_OVER_BUDGET,
+	AUDIT_EVENT_TIME_GAP=15
+}AuditLog_Event;
+
+typedef struct{
+	uint16 sequence;
+	uint8 count; /* number of events in the page */
+	uint8 events[AUDIT_LOG_EVENTS_PER_PAGE * AUDIT_LOG_EVENT_SIZE];
+	uint8 crc;   /* CRC-8 of all the previous bytes */
+}AuditLog_PageType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Find the next page of the ring with a binary search over the sequence numbers
+ * and record the boot event.
+ */
+void AuditLog_init(void);
+
+/*
+ * Description :
+ * Stage an event in RAM only, it never waits for the EEPROM.
+ * If both RAM pages are waiting for the EEPROM the event is dropped and counted.
+ */
+void AuditLog_record(AuditLog_Event event,uint8 user);
+
+/*
+ * Description :
+ * Background task called from the main loop: writes a full staged page to the
+ * EEPROM as one asynchronous page write when the TWI is free. It checks in with
+ * the watchdog while no page waits and each time a page is written.
+ */
+void AuditLog_task(void);
+
+/*
+ * Description :
+ * Stream the whole log, oldest page first, through a_send:
+ * the number of pages (16-bit little endian) then every 16 bytes page, one call each,
+ * the pages still staged in RAM are sent last. Link_send fits as a_send.
+ */
+void AuditLog_export(void(*a_send)(const uint8 *data,uint8 length));
+
+/*
+ * Description :
+ * Return the number of events dropped because the EEPROM did not keep up.
+ */
+uint16 AuditLog_getDropped(void);
+
+#endif /* AUDIT_LOG_H_ */
@@ -0,0 +1,127 @@
+ /******************************************************************************
+ *
+ * Module: Baud
+ *
+ * File Name: baud.h
+ *
+ * Description: Header file for the baud rate negotiation between HMI and Control
+ *
+ *******************************************************************************/
+
+#ifndef BAUD_H_
+#define BAUD_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+#ifndef SUCCESS
+#define ERROR 0
+#define SUCCESS 1
+#endif
+
+/* rate of every ECU after its reset, the two sides always meet there */
+#define BAUD_SAFE_RATE               9600UL
+
+/*
+ * Fastest rate this build offers, the receive interrupt must come within the 2 bytes
+ * of the receive FIFO and the shift register: 120us (960 cycles) at 250k, 60us at 500k,
+ * computed at 10 bits per byte. The throughput really reached is measured by each
+ * negotiation, see BAUD_MEASURE_SIZE.
+ */
+#define BAUD_MAX_RATE                250000UL
+
+/* rates that may be negotiated, from the slowest, the first one is BAUD_SAFE_RATE */
+#define BAUD_RATES                   {9600UL,19200UL,38400UL,76800UL,250000UL,500000UL}
+#define BAUD_RATES_NUMBER            6
+
+/* order of HMI_ECU opening a negotiation, followed by its rates mask */
+#define BAUD_HELLO                   0x11
+
+/* bytes sent at a new rate and echoed back before it is kept */
+#define BAUD_CHECK_PATTERN           {0x55,0xAA,0x0F,0xF0}
+#define BAUD_CHECK_SIZE              4
+
+/*
+ * Longest wait for the bytes of a negotiation step, a HELLO is sent again this many
+ * times so Control_ECU has about one second to boot
+ */
+#define BAUD_TIMEOUT_MS              100
+#define BAUD_HELLO_ATTEMPTS          10
+
+/* both sides leave their last byte before switching, 2 bytes at 9600 */
+#define BAUD_SWITCH_DELAY_MS         3
+
+/* receive errors at the current rate before it is given up */
+#define BAUD_ERRORS_MAX              3
+
+/*
+ * Bytes streamed by HMI_ECU once a rate above BAUD_SAFE_RATE passed its check: Control_ECU
+ * times them on the 1ms tick, from the first to the last one read from its receive ring,
+ * and sends back the bytes/s (32-bit little endian). 512 bytes take 20ms at 250k, about 5%
+ * of resolution, and 267ms at 19200. Received in chunks of BAUD_MEASURE_CHUNK.
+ */
+#define BAUD_MEASURE_SIZE            512
+#define BAUD_MEASURE_CHUNK           16
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+/* HMI_ECU opens the negotiations, Control_ECU answers them */
+typedef enum
+{
+	BAUD_HMI,BAUD_CONTROL
+}Baud_Role;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Find the rates this ECU can run within the UART tolerance and start at BAUD_SAFE_RATE,
+ * or on Control_ECU at the rate kept by the last negotiation after a watchdog reset.
+ * Must be called after UART_init, and on Control_ECU after Watchdog_init.
+ * The negotiation needs Tick_init.
+ */
+void Baud_init(Baud_Role role);
+
+/*
+ * Description :
+ * HMI side: agree with Control_ECU on the fastest rate both run, check it with an echo
+ * and step down to the next common rate when the check fails. Return the rate in use.
+ */
+uint32 Baud_negotiate(void);
+
+/*
+ * Description :
+ * Control side: answer a BAUD_HELLO already read from the UART, switch to the agreed rate
+ * and echo the check bytes, go back to BAUD_SAFE_RATE if they do not arrive right.
+ */
+void Baud_answer(void);
+
+/*
+ * Description :
+ * Give up the current rate when the receive errors rise: HMI_ECU negotiates again without
+ * it, Control_ECU goes back to BAUD_SAFE_RATE and waits for the next BAUD_HELLO.
+ * HMI_ECU also negotiates again while Control_ECU never answered.
+ * Return TRUE if the rate changed.
+ */
+boolean Baud_task(void);
+
+/*
+ * Description :
+ * Return the baud rate in use.
+ */
+uint32 Baud_getRate(void);
+
+/*
+ * Description :
+ * Return the bytes/s measured by Control_ECU at the rate in use, 0 if it was not measured
+ * (BAUD_SAFE_RATE or a failed measure).
+ */
+uint32 Baud_getThroughput(void);
+
+#endif /* BAUD_H_ */
@@ -8,30 +8,171 @@
 #include "buzzer.h"
 #include "common_macros.h"
 #include "gpio.h"
+#include "tick.h"
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+
+/*******************************************************************************
+ *                       Pattern Tables                                   *
+ *******************************************************************************/
+
+static const Buzzer_StepType g_steps[] PROGMEM =
+{
+	/* alarm: two tones siren, 1 second for each repeat */
+	{1,50},{2,50},
+	/* key click */
+	{1,2},
+	/* success: two rising chirps */
+	{2,8},{BUZZER_SILENT,4},{1,12},
+	/* lockout warning: three short beeps */
+	{1,10},{BUZZER_SILENT,10},{1,10},{BUZZER_SILENT,10},{1,10}
+};
+
+/* indexed by Buzzer_PatternType */
+static const Buzzer_PatternConfigType g_patterns[] PROGMEM =
+{
+	{0,2,60},   /* BUZZER_PATTERN_ALARM for 1 minute */
+	{2,1,1},    /* BUZZER_PATTERN_KEY_CLICK */
+	{3,3,1},    /* BUZZER_PATTERN_SUCCESS */
+	{6,5,1}     /* BUZZER_PATTERN_LOCKOUT_WARNING */
+};
+
+/* state of the pattern being played, changed by the tick interrupt */
+static volatile boolean g_isPlaying = FALSE;
+static volatile uint8 g_step;
+static volatile uint8 g_lastStep;
+static volatile uint8 g_firstStep;
+static volatile uint8 g_repeatsLeft;
+static volatile uint8 g_tone;
+static volatile uint8 g_toneCount;
+static volatile uint8 g_level;
+static volatile uint16 g_stepMsLeft;
+
+/*******************************************************************************
+ *                      Private Functions                                  *
+ *******************************************************************************/
+
+/* load a step from flash, called with the tick interrupt masked */
+static void Buzzer_loadStep(uint8 step)
+{
+	g_step = step;
+	g_tone = pgm_read_byte(&g_steps[step].tone);
+	g_stepMsLeft = (uint16)pgm_read_byte(&g_steps[step].duration) * BUZZER_STEP_UNIT_MS;
+	g_toneCount = 0;
+	g_level = (g_tone == BUZZER_SILENT) ? LOGIC_LOW : LOGIC_HIGH;
+	GPIO_writePin(BUZZER_PORT_ID,BUZZER_PIN_ID,g_level);
+}
+
+/* this function is executed each 1 millisecond from the tick interrupt */
+static void Buzzer_tick(void)
+{
+	if(!g_isPlaying)
+	{
+		return;
+	}
+
+	/* square wave of the step tone */
+	if(g_tone != BUZZER_SILENT)
+	{
+		g_toneCount++;
+		if(g_toneCount >= g_tone)
+		{
+			g_toneCount = 0;
+			g_level ^= LOGIC_HIGH;
+			GPIO_writePin(BUZZER_PORT_ID,BUZZER_PIN_ID,g_level);
+		}
+	}
+
+	g_stepMsLeft--;
+	if(g_stepMsLeft != 0)
+	{
+		return;
+	}
+
+	if(g_step != g_lastStep)
+	{
+		Buzzer_loadStep(g_step + 1);
+	}
+	else if((g_repeatsLeft == BUZZER_REPEAT_FOREVER) || (--g_repeatsLeft != 0))
+	{
+		Buzzer_loadStep(g_firstStep);
+	}
+	else
+	{
+		g_isPlaying = FALSE;
+		GPIO_writePin(BUZZER_PORT_ID,BUZZER_PIN_ID,LOGIC_LOW);
+	}
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
 
 /* Description
   ⮚ Setup the direction for the buzzer pin as output pin through the GPIO driver.
   ⮚ Turn off the buzzer through the GPIO.
+  ⮚ Hook the pattern engine on the 1ms tick, Tick_init must be called first.
  */
 void Buzzer_init(void)
 {
 	GPIO_setupPinDirection(BUZZER_PORT_ID,BUZZER_PIN_ID,PIN_OUTPUT);
 	GPIO_writePin(BUZZER_PORT_ID,BUZZER_PIN_ID,LOGIC_LOW);
+	Tick_addCallBack(Buzzer_tick);
 }
 
 /* Description
-   ⮚ Function to enable the Buzzer through the GPIO.
+   ⮚ Function to enable the Buzzer through the GPIO, a playing pattern is stopped.
    */
 void Buzzer_on(void)
 {
+	g_isPlaying = FALSE;
 	GPIO_writePin(BUZZER_PORT_ID,BUZZER_PIN_ID,LOGIC_HIGH);
 }
 
 
 /* Description
-   ⮚ Function to disable the Buzzer through the GPIO.
+   ⮚ Function to disable the Buzzer through the GPIO, a playing pattern is stopped.
 */
 void Buzzer_off(void)
 {
+	g_isPlaying = FALSE;
 	GPIO_writePin(BUZZER_PORT_ID,BUZZER_PIN_ID,LOGIC_LOW);
 }
+
+/* Description
+   ⮚ Start a pattern in the background and return at once, it replaces the pattern being played.
+*/
+void Buzzer_play(Buzzer_PatternType pattern)
+{
+	uint8 sreg = SREG;
+
+	cli();
+	g_firstStep = pgm_read_byte(&g_patterns[pattern].first_step);
+	g_lastStep = g_firstStep + pgm_read_byte(&g_patterns[pattern].steps_number) - 1;
+	g_repeatsLeft = pgm_read_byte(&g_patterns[pattern].repeat);
+	Buzzer_loadStep(g_firstStep);
+	g_isPlaying = TRUE;
+	SREG = sreg;
+}
+
+/* Description
+   ⮚ Stop the pattern being played and turn off the Buzzer.
+*/
+void Buzzer_stop(void)
+{
+	uint8 sreg = SREG;
+
+	/* the interrupt must not load a new step after the pin is cleared */
+	cli();
+	g_isPlaying = FALSE;
+	GPIO_writePin(BUZZER_PORT_ID,BUZZER_PIN_ID,LOGIC_LOW);
+	SREG = sreg;
+}
+
+/* Description
+   ⮚ Return TRUE while a pattern is being played.
+*/
+boolean Buzzer_isPlaying(void)
+{
+	return g_isPlaying;
+}
@@ -13,6 +13,40 @@
 #define BUZZER_PORT_ID              PORTA_ID
 #define BUZZER_PIN_ID               PIN0_ID
 
+/*
+ * Tone of a pattern step: the pin is toggled each tone milliseconds by the 1ms tick,
+ * so 1 gives 500Hz and 2 gives 250Hz. BUZZER_SILENT keeps the pin low.
+ */
+#define BUZZER_SILENT               0
+
+/* Step durations are stored in units of 10ms to fit one byte */
+#define BUZZER_STEP_UNIT_MS         10
+
+/* Repeats of a pattern that plays until Buzzer_stop is called */
+#define BUZZER_REPEAT_FOREVER       0
+
+/*******************************************************************************
+ *                       definitions                                    *
+ *******************************************************************************/
+
+typedef enum
+{
+	BUZZER_PATTERN_ALARM,BUZZER_PATTERN_KEY_CLICK,BUZZER_PATTERN_SUCCESS,BUZZER_PATTERN_LOCKOUT_WARNING
+}Buzzer_PatternType;
+
+/* One step of a pattern, the tables live in flash */
+typedef struct {
+	uint8 tone;
+	uint8 duration; // in units of BUZZER_STEP_UNIT_MS
+} Buzzer_StepType;
+
+/* A pattern is a run of steps of the step table played repeat times */
+typedef struct {
+	uint8 first_step;
+	uint8 steps_number;
+	uint8 repeat;
+} Buzzer_PatternConfigType;
+
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
@@ -20,17 +54,33 @@
 /* Description
   ⮚ Setup the direction for the buzzer pin as output pin through the GPIO driver.
   ⮚ Turn off the buzzer through the GPIO.
+  ⮚ Hook the pattern engine on the 1ms tick, Tick_init must be called first.
  */
 void Buzzer_init(void);
 
 /* Description
-   ⮚ Function to enable the Buzzer through the GPIO.
+   ⮚ Function to enable the Buzzer through the GPIO, a playing pattern is stopped.
 */
 void Buzzer_on(void);
 
 /* Description
-   ⮚ Function to disable the Buzzer through the GPIO.
+   ⮚ Function to disable the Buzzer through the GPIO, a playing pattern is stopped.
 */
 void Buzzer_off(void);
 
+/* Description
+   ⮚ Start a pattern in the background and return at once, it replaces the pattern being played.
+*/
+void Buzzer_play(Buzzer_PatternType pattern);
+
+/* Description
+   ⮚ Stop the pattern being played and turn off the Buzzer.
+*/
+void Buzzer_stop(void);
+
+/* Description
+   ⮚ Return TRUE while a pattern is being played.
+*/
+boolean Buzzer_isPlaying(void);
+
 #endif /* BUZZER_H_ */
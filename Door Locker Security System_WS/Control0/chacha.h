@@ -0,0 +1,35 @@
+ /******************************************************************************
+ *
+ * Module: ChaCha
+ *
+ * File Name: chacha.h
+ *
+ * Description: Header file for the ChaCha8 stream cipher block function (128-bit key)
+ *
+ *******************************************************************************/
+
+#ifndef CHACHA_H_
+#define CHACHA_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define CHACHA_KEY_SIZE              16
+#define CHACHA_NONCE_SIZE            8
+#define CHACHA_BLOCK_SIZE            64
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Compute keystream block number counter for a key and a nonce (original ChaCha
+ * layout: 64-bit nonce, 32-bit block counter here) with 8 rounds.
+ */
+void ChaCha_block(const uint8 *key,const uint8 *nonce,uint32 counter,uint8 *output);
+
+#endif /* CHACHA_H_ */
@@ -0,0 +1,181 @@
+ /******************************************************************************
+ *
+ * Module: Challenge
+ *
+ * File Name: challenge.c
+ *
+ * Description: Source file for the challenge-response PIN check (Control side)
+ *
+ *******************************************************************************/
+
+#include "challenge.h"
+#include "cred_store.h"
+#include "user_table.h"
+#include "link.h"
+
+/* Next challenge: [system salt][user salt][nonce] and the MACs expected for it */
+static uint8 g_challenge[CHALLENGE_SIZE];
+static uint8 g_systemMac[CHALLENGE_MAC_SIZE];
+static boolean g_hasSystem = FALSE;
+/* Salt bytes and MAC of every enabled user for the next nonce, one bit per ready slot */
+static uint8 g_userSalts[USER_TABLE_MAX_USERS][USER_TABLE_SALT_SIZE];
+static uint8 g_userMacs[USER_TABLE_MAX_USERS][CHALLENGE_MAC_SIZE];
+static uint8 g_ready[(USER_TABLE_MAX_USERS + 7) / 8];
+/* Next slot to precompute, USER_TABLE_MAX_USERS once all are done */
+static uint8 g_nextSlot = USER_TABLE_MAX_USERS;
+/* Random salt and MAC sent for a tag of no enabled user, so it looks like any other */
+static uint8 g_decoySalt[PIN_HASH_SALT_SIZE];
+static uint8 g_decoyMac[CHALLENGE_MAC_SIZE];
+/* MAC of the one user the lookup tag points to, or of nothing */
+static uint8 g_userMac[CHALLENGE_MAC_SIZE];
+static uint8 g_candidate = USER_NOT_FOUND;
+/* The nonce, the system MAC and the decoy are ready */
+static boolean g_hasNonce = FALSE;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void Challenge_mac(const uint8 *hash,uint8 length,uint8 *mac);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void Challenge_init(void)
+{
+	Challenge_invalidate();
+}
+
+void Challenge_invalidate(void)
+{
+	g_hasNonce = FALSE;
+	g_candidate = USER_NOT_FOUND;
+}
+
+void Challenge_task(void)
+{
+	uint8 credential[PIN_HASH_RECORD_SIZE];
+	UserTable_EntryType entry;
+
+	if(!g_hasNonce)
+	{
+		/* new nonce and the salt of the system password */
+		PinHash_newSalt(&g_challenge[CHALLENGE_NONCE_INDEX]);
+
+		g_hasSystem = (CredStore_load(credential, PIN_HASH_RECORD_SIZE) == SUCCESS);
+		for(uint8 i = 0; i < PIN_HASH_SALT_SIZE; i++)
+		{
+			g_challenge[i] = g_hasSystem ? credential[i] : 0;
+		}
+		if(g_hasSystem)
+		{
+			Challenge_mac(&credential[PIN_HASH_SALT_SIZE], PIN_HASH_SIZE, g_systemMac);
+		}
+		PinHash_newSalt(g_decoySalt);
+		PinHash_newSalt(g_decoyMac);
+		for(uint8 i = 0; i < sizeof(g_ready); i++)
+		{
+			g_ready[i] = 0;
+		}
+		g_nextSlot = 0;
+		g_hasNonce = TRUE;
+		return;
+	}
+
+	/* one user per call so an order is not kept waiting, free slots cost no EEPROM read */
+	while(g_nextSlot < USER_TABLE_MAX_USERS)
+	{
+		if((UserTable_read(g_nextSlot, &entry) == SUCCESS) && (entry.flags & USER_FLAG_ENABLED))
+		{
+			for(uint8 i = 0; i < USER_TABLE_SALT_SIZE; i++)
+			{
+				g_userSalts[g_nextSlot][i] = entry.salt[i];
+			}
+			Challenge_mac(entry.hash, USER_TABLE_HASH_SIZE, g_userMacs[g_nextSlot]);
+			g_ready[g_nextSlot / 8] |= (1 << (g_nextSlot % 8));
+			g_nextSlot++;
+			return;
+		}
+		g_nextSlot++;
+	}
+}
+
+boolean Challenge_isBusy(void)
+{
+	return (!g_hasNonce) || (g_nextSlot < USER_TABLE_MAX_USERS);
+}
+
+void Challenge_send(uint16 tag)
+{
+	/* the idle time was not enough: finish the precomputation first */
+	while(Challenge_isBusy())
+	{
+		Challenge_task();
+	}
+
+	/* only an enabled user can open the door, any other tag gets the decoy: a RAM lookup and copies */
+	g_candidate = UserTable_lookupTag(tag);
+	if((g_candidate != USER_NOT_FOUND) && (g_ready[g_candidate / 8] & (1 << (g_candidate % 8))))
+	{
+		UserTable_getSalt(g_candidate, g_userSalts[g_candidate], &g_challenge[PIN_HASH_SALT_SIZE]);
+		for(uint8 i = 0; i < CHALLENGE_MAC_SIZE; i++)
+		{
+			g_userMac[i] = g_userMacs[g_candidate][i];
+		}
+	}
+	else
+	{
+		g_candidate = USER_NOT_FOUND;
+		for(uint8 i = 0; i < PIN_HASH_SALT_SIZE; i++)
+		{
+			g_challenge[PIN_HASH_SALT_SIZE + i] = g_decoySalt[i];
+		}
+		for(uint8 i = 0; i < CHALLENGE_MAC_SIZE; i++)
+		{
+			g_userMac[i] = g_decoyMac[i];
+		}
+	}
+	Link_send(g_challenge, CHALLENGE_SIZE);
+}
+
+uint8 Challenge_check(const uint8 *response)
+{
+	uint8 result = USER_NOT_FOUND;
+	uint8 match;
+
+	if(g_hasNonce)
+	{
+		/* both MACs are compared and the result is picked by a mask, no branch on a match */
+		match = (uint8)-(uint8)(PinHash_isEqual(&response[CHALLENGE_MAC_SIZE], g_userMac, CHALLENGE_MAC_SIZE) &
+				(g_candidate != USER_NOT_FOUND));
+		result = (result & (uint8)~match) | (g_candidate & match);
+		/* the system password wins over a user with the same answer */
+		match = (uint8)-(uint8)(PinHash_isEqual(response, g_systemMac, CHALLENGE_MAC_SIZE) & g_hasSystem);
+		result = (result & (uint8)~match) | (CHALLENGE_SYSTEM & match);
+	}
+
+	/* one answer per nonce, the next one is precomputed while idle */
+	Challenge_invalidate();
+	return result;
+}
+
+/*
+ * Description :
+ * MAC of the nonce keyed by a stored PIN hash (a user hash is padded with zeros to the key size).
+ */
+static void Challenge_mac(const uint8 *hash, uint8 length, uint8 *mac)
+{
+	uint8 key[SIPHASH_KEY_SIZE];
+	uint8 output[SIPHASH_OUTPUT_SIZE];
+
+	for(uint8 i = 0; i < SIPHASH_KEY_SIZE; i++)
+	{
+		key[i] = (i < length) ? hash[i] : 0;
+	}
+	SipHash_compute(key, &g_challenge[CHALLENGE_NONCE_INDEX], CHALLENGE_NONCE_SIZE, output);
+	for(uint8 i = 0; i < CHALLENGE_MAC_SIZE; i++)
+	{
+		mac[i] = output[i];
+	}
+}
@@ -0,0 +1,85 @@
+ /******************************************************************************
+ *
+ * Module: Challenge
+ *
+ * File Name: challenge.h
+ *
+ * Description: Header file for the challenge-response PIN check (Control side)
+ *
+ *******************************************************************************/
+
+#ifndef CHALLENGE_H_
+#define CHALLENGE_H_
+
+#include "std_types.h"
+#include "pin_hash.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/*
+ * Request (one encrypted link frame): [lookup tag of the PIN:2], see user_table.h
+ * Challenge (one encrypted link frame): [system salt:4][user salt:4][nonce:4]
+ * Response: [MAC of the system password:4][MAC of the user PIN:4]
+ * The user salt is the one of the slot the tag points to (a random one if none).
+ * A MAC is HalfSipHash keyed by the stored hash of a PIN over the nonce, so the
+ * HMI proves it knows the PIN without sending it, and an answer is valid for one nonce.
+ * The HMI derives the device key of the hashes from the link key, it is never sent.
+ */
+#define CHALLENGE_TAG_SIZE           2
+#define CHALLENGE_NONCE_SIZE         4
+#define CHALLENGE_MAC_SIZE           4
+#define CHALLENGE_NONCE_INDEX        (2 * PIN_HASH_SALT_SIZE)
+#define CHALLENGE_SIZE               (CHALLENGE_NONCE_INDEX + CHALLENGE_NONCE_SIZE)
+#define CHALLENGE_RESPONSE_SIZE      (2 * CHALLENGE_MAC_SIZE)
+
+/* Challenge_check result for the system password, users give their slot */
+#define CHALLENGE_SYSTEM             0xFE
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Start the precomputation of the first nonce, call after CredStore_init and UserTable_init.
+ */
+void Challenge_init(void);
+
+/*
+ * Description :
+ * Drop the precomputed nonce and MACs after a change of the password or of the users.
+ */
+void Challenge_invalidate(void);
+
+/*
+ * Description :
+ * Idle work of the main loop: precompute the next nonce and the system MAC, then the
+ * salt and MAC of one enabled user per call (one EEPROM read and one HalfSipHash).
+ */
+void Challenge_task(void);
+
+/*
+ * Description :
+ * Return TRUE while the precomputation is not finished, the ECU must not sleep then.
+ */
+boolean Challenge_isBusy(void);
+
+/*
+ * Description :
+ * Finish the precomputation if the idle time was not enough, find the slot of the
+ * lookup tag in the RAM index and send the challenge with its precomputed salt.
+ * No EEPROM read and no hash are left to do once the precomputation is done.
+ */
+void Challenge_send(uint16 tag);
+
+/*
+ * Description :
+ * Compare a response with the system MAC and the MAC of the slot of the tag, in a time
+ * that does not tell which one matched, and use up the nonce.
+ * Return CHALLENGE_SYSTEM, the slot of an enabled user, or USER_NOT_FOUND.
+ */
+uint8 Challenge_check(const uint8 *response);
+
+#endif /* CHALLENGE_H_ */
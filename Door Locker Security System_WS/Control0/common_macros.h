@@ -35,4 +35,7 @@
 
 #define GET_BIT(REG,BIT) ( ( REG & (1<<BIT) ) >> BIT )
 
+/* Absolute value of a signed number */
+#define ABS(X) ( ((X) < 0) ? -(X) : (X) )
+
 #endif
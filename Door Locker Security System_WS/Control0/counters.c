@@ -0,0 +1,183 @@
+ /******************************************************************************
+ *
+ * Module: Counters
+ *
+ * File Name: counters.c
+ *
+ * Description: Source file for the write coalescing persistent counters
+ *
+ *******************************************************************************/
+
+#include "counters.h"
+#include "storage.h"
+#include "tick.h"
+#include "watchdog.h"
+#include <util/crc16.h>
+
+/*
+ * kept over a reset: not cleared by the startup code, so the events not saved before a
+ * watchdog or brown-out reset are found at the next boot while the RAM kept its content
+ */
+static struct{
+	uint16 magic;
+	Counters_RecordType record;
+}g_noInit __attribute__((section(".noinit")));
+static Counters_ConfigType g_config = {COUNTERS_FLUSH_EVENTS, COUNTERS_FLUSH_INTERVAL_MS};
+/* Slot of the last save */
+static uint8 g_slot = COUNTERS_SLOTS - 1;
+/* Events added since the last save and time of the first of them */
+static uint16 g_unsavedEvents = 0;
+static uint32 g_firstUnsavedMs = 0;
+static uint8 g_watchdogTask = WATCHDOG_NO_TASK;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static uint8 Counters_crc(const Counters_RecordType *record_Ptr);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void Counters_init(const Counters_ConfigType * Config_Ptr)
+{
+	Counters_RecordType record;
+	Counters_RecordType newest;
+	boolean isFound = FALSE;
+	boolean isKept;
+
+	g_config = *Config_Ptr;
+	g_unsavedEvents = 0;
+
+	/* The newest valid slot, the sequence numbers are compared modulo 65536 */
+	for(uint8 slot = 0; slot < COUNTERS_SLOTS; slot++)
+	{
+		if((Storage_read(STORAGE_COUNTERS, (uint16)slot * COUNTERS_SLOT_SIZE, (uint8 *)&record, sizeof(record)) == SUCCESS) &&
+				(record.crc == Counters_crc(&record)) &&
+				((!isFound) || ((sint16)(record.sequence - newest.sequence) > 0)))
+		{
+			newest = record;
+			g_slot = slot;
+			isFound = TRUE;
+		}
+	}
+
+	if(!isFound)
+	{
+		newest.sequence = 0;
+		for(uint8 i = 0; i < COUNTERS_NUMBER; i++)
+		{
+			newest.values[i] = 0;
+		}
+		g_slot = COUNTERS_SLOTS - 1;
+	}
+
+	/*
+	 * The RAM is random after a power on: the kept record is only taken when it is valid
+	 * and continues the newest saved one, its unsaved events are then saved at once
+	 */
+	isKept = (g_noInit.magic == COUNTERS_KEPT_MAGIC) && (g_noInit.record.crc == Counters_crc(&g_noInit.record)) &&
+			(g_noInit.record.sequence == newest.sequence);
+	for(uint8 i = 0; (i < COUNTERS_NUMBER) && isKept; i++)
+	{
+		isKept = (g_noInit.record.values[i] >= newest.values[i]);
+		if(g_noInit.record.values[i] != newest.values[i])
+		{
+			g_unsavedEvents = 1;
+		}
+	}
+	if(!isKept)
+	{
+		g_unsavedEvents = 0;
+		g_noInit.record = newest;
+	}
+	g_noInit.magic = COUNTERS_KEPT_MAGIC;
+	g_watchdogTask = Watchdog_register(COUNTERS_SAVE_DEADLINE_MS);
+	Counters_flush();
+}
+
+void Counters_add(Counters_Id id, uint32 amount)
+{
+	if(g_unsavedEvents == 0)
+	{
+		g_firstUnsavedMs = Tick_getMs();
+	}
+	g_noInit.record.values[id] += amount;
+	/* valid for the next boot if a reset comes before the save */
+	g_noInit.record.crc = Counters_crc(&g_noInit.record);
+	if(g_unsavedEvents != 0xFFFF)
+	{
+		g_unsavedEvents++;
+	}
+}
+
+uint32 Counters_get(Counters_Id id)
+{
+	return g_noInit.record.values[id];
+}
+
+void Counters_task(void)
+{
+	boolean isDue;
+
+	if(g_unsavedEvents == 0)
+	{
+		Watchdog_checkIn(g_watchdogTask);
+		return;
+	}
+	isDue = ((g_config.flush_events != 0) && (g_unsavedEvents >= g_config.flush_events)) ||
+			((g_config.flush_interval_ms != 0) && ((Tick_getMs() - g_firstUnsavedMs) >= g_config.flush_interval_ms));
+	if(isDue)
+	{
+		Counters_flush();
+	}
+	/* a due save that fails is retried on each call, without checking in */
+	if((!isDue) || (g_unsavedEvents == 0))
+	{
+		Watchdog_checkIn(g_watchdogTask);
+	}
+}
+
+void Counters_flush(void)
+{
+	Counters_RecordType record;
+	uint8 slot;
+
+	if(g_unsavedEvents == 0)
+	{
+		return;
+	}
+
+	/*
+	 * A new record in the next slot: a torn save leaves the previous slot valid.
+	 * The slot and the sequence are only taken once the write is queued, a failed
+	 * save is retried in the same slot and never overwrites the last good record
+	 */
+	slot = (uint8)((g_slot + 1) % COUNTERS_SLOTS);
+	record = g_noInit.record;
+	record.sequence++;
+	record.crc = Counters_crc(&record);
+	if(Storage_write(STORAGE_COUNTERS, (uint16)slot * COUNTERS_SLOT_SIZE, (const uint8 *)&record, sizeof(record)) == SUCCESS)
+	{
+		g_noInit.record = record;
+		g_slot = slot;
+		g_unsavedEvents = 0;
+	}
+}
+
+/*
+ * Description :
+ * CRC-8 (polynomial 0x07) of the record without its crc byte.
+ */
+static uint8 Counters_crc(const Counters_RecordType *record_Ptr)
+{
+	const uint8 *bytes = (const uint8 *)record_Ptr;
+	uint8 crc = 0;
+
+	for(uint8 i = 0; i < (sizeof(Counters_RecordType) - 1); i++)
+	{
+		crc = _crc8_ccitt_update(crc, bytes[i]);
+	}
+	return crc;
+}
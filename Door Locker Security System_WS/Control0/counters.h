@@ -0,0 +1,101 @@
+ /******************************************************************************
+ *
+ * Module: Counters
+ *
+ * File Name: counters.h
+ *
+ * Description: Header file for the write coalescing persistent counters
+ *
+ *******************************************************************************/
+
+#ifndef COUNTERS_H_
+#define COUNTERS_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/*
+ * The counters live in RAM and are saved together as one record, only when
+ * enough events were added or the flush interval passed. Each save takes the next
+ * of COUNTERS_SLOTS rotating slots of the STORAGE_COUNTERS record.
+ */
+#define COUNTERS_NUMBER              3
+#define COUNTERS_SLOTS               16
+#define COUNTERS_SLOT_SIZE           16
+
+/* default policy: save after 16 events, or 10 minutes after the first unsaved one */
+#define COUNTERS_FLUSH_EVENTS        16
+#define COUNTERS_FLUSH_INTERVAL_MS   600000UL
+
+/*
+ * the save is a watchdog task of its own: a due save still failing after this time
+ * resets the ECU, the unsaved events are kept over the reset
+ */
+#define COUNTERS_SAVE_DEADLINE_MS    5000UL
+
+/* marks the RAM record kept over a reset, see Counters_init */
+#define COUNTERS_KEPT_MAGIC          0xC047
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef enum
+{
+	COUNTER_DOOR_CYCLES,COUNTER_MOTOR_SECONDS,COUNTER_FAILED_ATTEMPTS
+}Counters_Id;
+
+typedef struct{
+	uint16 flush_events;      /* save once this many events are unsaved, 0 = never by count */
+	uint32 flush_interval_ms; /* save unsaved events after this time, 0 = never by time */
+}Counters_ConfigType;
+
+typedef struct{
+	uint16 sequence;
+	uint32 values[COUNTERS_NUMBER];
+	uint8 crc;       /* CRC-8 of all the previous bytes */
+}Counters_RecordType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Load the newest valid slot (all counters start from 0 if there is none).
+ * After a watchdog or brown-out reset that kept the RAM, the events added since that
+ * slot are taken from the RAM record and saved at once. Must be called after Tick_init.
+ */
+void Counters_init(const Counters_ConfigType * Config_Ptr);
+
+/*
+ * Description :
+ * Add amount to a counter in RAM, it is saved later by Counters_task.
+ */
+void Counters_add(Counters_Id id,uint32 amount);
+
+/*
+ * Description :
+ * Return the current value of a counter, unsaved events included.
+ */
+uint32 Counters_get(Counters_Id id);
+
+/*
+ * Description :
+ * Save the counters if the event or the time threshold is reached, called from the main loop.
+ * It checks in with the watchdog unless a due save keeps failing.
+ */
+void Counters_task(void);
+
+/*
+ * Description :
+ * Save the unsaved events now. This is the hook of a power fail warning and
+ * must also be called before any planned reset, Counters_init calls it for the
+ * events kept over an unplanned one.
+ */
+void Counters_flush(void);
+
+#endif /* COUNTERS_H_ */
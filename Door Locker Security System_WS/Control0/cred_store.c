@@ -0,0 +1,264 @@
+ /******************************************************************************
+ *
+ * Module: Credential Store
+ *
+ * File Name: cred_store.c
+ *
+ * Description: Source file for the credential store (hot copy and wear leveled log)
+ *
+ *******************************************************************************/
+
+#include "cred_store.h"
+#include "storage.h"
+#include <util/crc16.h>
+
+/* Slot and sequence number of the newest valid record */
+static uint8 g_headSlot = 0;
+static uint16 g_headSequence = 0;
+static boolean g_isEmpty = TRUE;
+/* Hot slot holding the newest record */
+static uint8 g_hotSlot = 0;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static boolean CredStore_readHeader(uint8 slot,uint16 *sequence_Ptr);
+static boolean CredStore_readRecord(uint8 slot,CredStore_RecordType *record_Ptr);
+static boolean CredStore_isValid(const CredStore_RecordType *record_Ptr);
+static boolean CredStore_readHot(uint8 hotSlot,CredStore_RecordType *record_Ptr);
+static uint8 CredStore_commitHot(uint8 hotSlot,const CredStore_RecordType *record_Ptr);
+static uint8 CredStore_crc(const CredStore_RecordType *record_Ptr);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+uint8 CredStore_init(void)
+{
+	CredStore_RecordType record;
+	CredStore_RecordType other;
+	boolean isValid;
+	boolean isOtherValid;
+	uint16 firstSequence;
+	uint16 sequence;
+	uint8 low = 0;
+	uint8 high = CRED_STORE_RECORDS - 1;
+	uint8 mid;
+	uint8 slot;
+
+	g_isEmpty = TRUE;
+
+	/* The newest of the two committed hot slots, compared modulo 65536 */
+	isValid = CredStore_readHot(0, &record);
+	isOtherValid = CredStore_readHot(1, &other);
+	if(isValid || isOtherValid)
+	{
+		g_hotSlot = 0;
+		if((!isValid) || (isOtherValid && ((sint16)(other.sequence - record.sequence) > 0)))
+		{
+			g_hotSlot = 1;
+			record = other;
+		}
+		g_headSlot = (uint8)(record.sequence % CRED_STORE_RECORDS);
+		g_headSequence = record.sequence;
+		g_isEmpty = FALSE;
+		return SUCCESS;
+	}
+
+	/* The log is filled from the first slot, an erased first slot means an empty log */
+	if(!CredStore_readHeader(0, &firstSequence))
+	{
+		return ERROR;
+	}
+
+	/*
+	 * Slots written during the current lap of the ring hold firstSequence + slot,
+	 * the others still hold the older lap or are erased: binary search the last one.
+	 */
+	while(low < high)
+	{
+		mid = (uint8)((low + high + 1) / 2);
+		if(CredStore_readHeader(mid, &sequence) && ((uint16)(sequence - firstSequence) == mid))
+		{
+			low = mid;
+		}
+		else
+		{
+			high = mid - 1;
+		}
+	}
+
+	/* Take the newest record, or the one before it if the newest one is corrupted */
+	for(uint8 i = 0; i < 2; i++)
+	{
+		slot = (uint8)((low + CRED_STORE_RECORDS - i) % CRED_STORE_RECORDS);
+		if(CredStore_readRecord(slot, &record))
+		{
+			g_headSlot = slot;
+			g_headSequence = record.sequence;
+			g_isEmpty = FALSE;
+			g_hotSlot = 0;
+			return CredStore_commitHot(g_hotSlot, &record);
+		}
+	}
+	return ERROR;
+}
+
+uint8 CredStore_save(const uint8 *data, uint8 length)
+{
+	CredStore_RecordType record;
+	uint8 slot;
+
+	if(length > CRED_STORE_DATA_SIZE)
+	{
+		return ERROR;
+	}
+
+	/* Next sequence number, its slot is the sequence modulo the ring size */
+	record.sequence = g_isEmpty ? 0 : (g_headSequence + 1);
+	slot = (uint8)(record.sequence % CRED_STORE_RECORDS);
+
+	record.length = length;
+	for(uint8 i = 0; i < CRED_STORE_DATA_SIZE; i++)
+	{
+		record.data[i] = (i < length) ? data[i] : 0;
+	}
+	record.crc = CredStore_crc(&record);
+
+	/* The log record first: a hot copy never gets ahead of the log */
+	if(Storage_write(STORAGE_CREDENTIAL_LOG, (uint16)slot * CRED_STORE_RECORD_SIZE, (const uint8 *)&record, CRED_STORE_RECORD_SIZE) == ERROR)
+	{
+		return ERROR;
+	}
+	if(CredStore_commitHot(1 - g_hotSlot, &record) == ERROR)
+	{
+		return ERROR;
+	}
+
+	g_hotSlot = 1 - g_hotSlot;
+	g_headSlot = slot;
+	g_headSequence = record.sequence;
+	g_isEmpty = FALSE;
+	return SUCCESS;
+}
+
+uint8 CredStore_load(uint8 *data, uint8 length)
+{
+	CredStore_RecordType record;
+
+	/* Read from the internal EEPROM, the log is only needed if the hot copy is damaged */
+	if(g_isEmpty || (length > CRED_STORE_DATA_SIZE))
+	{
+		return ERROR;
+	}
+	if((!CredStore_readHot(g_hotSlot, &record)) || (record.sequence != g_headSequence))
+	{
+		if(!CredStore_readRecord(g_headSlot, &record))
+		{
+			return ERROR;
+		}
+	}
+	if(length > record.length)
+	{
+		return ERROR;
+	}
+
+	for(uint8 i = 0; i < length; i++)
+	{
+		data[i] = record.data[i];
+	}
+	return SUCCESS;
+}
+
+/*
+ * Description :
+ * Read the sequence number and the length of a slot, return FALSE if it was never written.
+ */
+static boolean CredStore_readHeader(uint8 slot, uint16 *sequence_Ptr)
+{
+	uint8 header[3];
+
+	if(Storage_read(STORAGE_CREDENTIAL_LOG, (uint16)slot * CRED_STORE_RECORD_SIZE, header, sizeof(header)) == ERROR)
+	{
+		return FALSE;
+	}
+	*sequence_Ptr = header[0] | ((uint16)header[1] << 8);
+	return (header[2] != CRED_STORE_ERASED);
+}
+
+/*
+ * Description :
+ * Read a whole record and return TRUE if it is complete (valid length and CRC).
+ */
+static boolean CredStore_readRecord(uint8 slot, CredStore_RecordType *record_Ptr)
+{
+	if(Storage_read(STORAGE_CREDENTIAL_LOG, (uint16)slot * CRED_STORE_RECORD_SIZE, (uint8 *)record_Ptr, CRED_STORE_RECORD_SIZE) == ERROR)
+	{
+		return FALSE;
+	}
+	return CredStore_isValid(record_Ptr);
+}
+
+/*
+ * Description :
+ * Return TRUE if a record is complete (valid length and CRC).
+ */
+static boolean CredStore_isValid(const CredStore_RecordType *record_Ptr)
+{
+	return ((record_Ptr->length <= CRED_STORE_DATA_SIZE) && (record_Ptr->crc == CredStore_crc(record_Ptr)));
+}
+
+/*
+ * Description :
+ * Read a hot slot, return TRUE if it is committed and its record is complete.
+ */
+static boolean CredStore_readHot(uint8 hotSlot, CredStore_RecordType *record_Ptr)
+{
+	uint8 marker;
+	uint16 offset = (uint16)hotSlot * CRED_STORE_HOT_SLOT_SIZE;
+
+	if((Storage_read(STORAGE_CREDENTIAL, offset + CRED_STORE_RECORD_SIZE, &marker, 1) == ERROR) || (marker != CRED_STORE_COMMITTED))
+	{
+		return FALSE;
+	}
+	if(Storage_read(STORAGE_CREDENTIAL, offset, (uint8 *)record_Ptr, CRED_STORE_RECORD_SIZE) == ERROR)
+	{
+		return FALSE;
+	}
+	return CredStore_isValid(record_Ptr);
+}
+
+/*
+ * Description :
+ * Write a record to a hot slot: the marker is cleared before the record and set after it.
+ */
+static uint8 CredStore_commitHot(uint8 hotSlot, const CredStore_RecordType *record_Ptr)
+{
+	uint8 marker = CRED_STORE_UNCOMMITTED;
+	uint16 offset = (uint16)hotSlot * CRED_STORE_HOT_SLOT_SIZE;
+
+	if((Storage_write(STORAGE_CREDENTIAL, offset + CRED_STORE_RECORD_SIZE, &marker, 1) == ERROR) ||
+			(Storage_write(STORAGE_CREDENTIAL, offset, (const uint8 *)record_Ptr, CRED_STORE_RECORD_SIZE) == ERROR))
+	{
+		return ERROR;
+	}
+	marker = CRED_STORE_COMMITTED;
+	return Storage_write(STORAGE_CREDENTIAL, offset + CRED_STORE_RECORD_SIZE, &marker, 1);
+}
+
+/*
+ * Description :
+ * CRC-8 (polynomial 0x07) of the record without its crc byte.
+ */
+static uint8 CredStore_crc(const CredStore_RecordType *record_Ptr)
+{
+	const uint8 *bytes = (const uint8 *)record_Ptr;
+	uint8 crc = 0;
+
+	for(uint8 i = 0; i < (CRED_STORE_RECORD_SIZE - 1); i++)
+	{
+		crc = _crc8_ccitt_update(crc, bytes[i]);
+	}
+	return crc;
+}
@@ -0,0 +1,85 @@
+ /******************************************************************************
+ *
+ * Module: Credential Store
+ *
+ * File Name: cred_store.h
+ *
+ * Description: Header file for the credential store (hot copy and wear leveled log)
+ *
+ *******************************************************************************/
+
+#ifndef CRED_STORE_H_
+#define CRED_STORE_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/*
+ * The credential is never rewritten in place in the External EEPROM: every save
+ * appends a new record to a ring of CRED_STORE_RECORDS pages, so each page takes
+ * 1/CRED_STORE_RECORDS of the writes. One record is exactly one EEPROM page.
+ * The ring size is a power of 2 so the slot of a record is its sequence modulo
+ * CRED_STORE_RECORDS, even when the 16-bit sequence wraps.
+ * The newest record is also kept in the internal EEPROM: checks and boot read it
+ * without any bus transfer.
+ */
+#define CRED_STORE_RECORDS           32
+#define CRED_STORE_RECORD_SIZE       16
+#define CRED_STORE_DATA_SIZE         12
+
+/*
+ * The internal copy is double buffered: a save rewrites only the older of the two
+ * hot slots, as clear marker -> record -> commit marker (the bytes are programmed
+ * in this order), so a power failure leaves at worst one uncommitted slot and the
+ * other one still holds the previous credential.
+ */
+#define CRED_STORE_HOT_SLOTS         2
+#define CRED_STORE_HOT_SLOT_SIZE     32
+#define CRED_STORE_COMMITTED         0xA5
+#define CRED_STORE_UNCOMMITTED       0x00
+
+/* length byte of a page never written (erased EEPROM reads 0xFF) */
+#define CRED_STORE_ERASED            0xFF
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef struct{
+	uint16 sequence; /* incremented by every save, modulo 65536 */
+	uint8 length;
+	uint8 data[CRED_STORE_DATA_SIZE];
+	uint8 crc;       /* CRC-8 of all the previous bytes */
+}CredStore_RecordType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Read the two hot slots and take the newest committed one with a good CRC, the
+ * boot cost is always two internal EEPROM reads. If both are unusable, find the
+ * newest valid record of the log with a binary search over the sequence numbers
+ * (about log2(CRED_STORE_RECORDS) header reads), falling back to the previous
+ * record if the newest one was torn, and copy it again.
+ * Return SUCCESS if a credential is stored, ERROR if the log is empty.
+ */
+uint8 CredStore_init(void);
+
+/*
+ * Description :
+ * Append a new record holding data to the log and commit it to the older hot slot.
+ */
+uint8 CredStore_save(const uint8 *data,uint8 length);
+
+/*
+ * Description :
+ * Read the newest credential into data after checking its CRC.
+ */
+uint8 CredStore_load(uint8 *data,uint8 length);
+
+#endif /* CRED_STORE_H_ */
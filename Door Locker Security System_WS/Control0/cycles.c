@@ -0,0 +1,63 @@
+ /******************************************************************************
+ *
+ * Module: Cycles
+ *
+ * File Name: cycles.c
+ *
+ * Description: Source file for the CPU cycle count of a code path on Timer1
+ *
+ *******************************************************************************/
+
+#include "cycles.h"
+#include "timer1.h"
+#include "avr/io.h"
+#include <avr/interrupt.h>
+
+static volatile uint16 g_overflows = 0;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void Cycles_overflow(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void Cycles_start(void)
+{
+	Timer1_ConfigType config = {0,0,NO_PRESCALING,NORMAL_MODE};
+
+	g_overflows = 0;
+	Timer1_setCallBack(Cycles_overflow);
+	Timer1_init(&config);
+}
+
+uint32 Cycles_stop(void)
+{
+	uint16 count;
+	uint16 overflows;
+	uint8 sreg = SREG;
+
+	/* TCNT1 and the overflows are read together, an overflow not yet served is counted */
+	cli();
+	count = TCNT1;
+	overflows = g_overflows;
+	if((TIFR & (1 << TOV1)) && (count < 0x8000))
+	{
+		overflows++;
+	}
+	SREG = sreg;
+	Timer1_deInit();
+	return ((uint32)overflows << 16) | count;
+}
+
+/*
+ * Description :
+ * Timer1 overflow: 65536 more cycles.
+ */
+static void Cycles_overflow(void)
+{
+	g_overflows++;
+}
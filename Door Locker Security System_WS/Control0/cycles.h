@@ -0,0 +1,34 @@
+ /******************************************************************************
+ *
+ * Module: Cycles
+ *
+ * File Name: cycles.h
+ *
+ * Description: Header file for the CPU cycle count of a code path on Timer1
+ *
+ *******************************************************************************/
+
+#ifndef CYCLES_H_
+#define CYCLES_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Run Timer1 from zero at F_CPU, its overflows extend the count to 32 bits.
+ * Timer1 must be free: not during DelaySecondTimer1.
+ */
+void Cycles_start(void);
+
+/*
+ * Description :
+ * Stop Timer1 and return the cycles since Cycles_start, the interrupts served
+ * meanwhile included as on the real path.
+ */
+uint32 Cycles_stop(void);
+
+#endif /* CYCLES_H_ */
@@ -8,7 +8,213 @@
 #include "common_macros.h"
 #include "gpio.h"
 #include "pwm.h"
+#include "adc.h"
+#include "tick.h"
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
 
+/*******************************************************************************
+ *                       Ramp Curves                                   *
+ *******************************************************************************/
+
+/* percent of the way from the start speed to the target speed at each point */
+static const uint8 g_accelCurve[] PROGMEM =
+{
+	2,5,10,17,25,34,44,53,62,70,78,85,90,95,98,100
+};
+
+static const uint8 g_decelCurve[] PROGMEM =
+{
+	4,12,22,34,47,60,72,83,92,100
+};
+
+typedef enum
+{
+	DC_MOTOR_IDLE,DC_MOTOR_RAMP,DC_MOTOR_DEAD_TIME
+}DcMotor_RampState;
+
+/* the order of DcMotor_Rotate, reached by the tick interrupt */
+static volatile DcMotor_State g_requestState = STOP;
+static volatile uint8 g_requestSpeed = 0;
+
+/* what the H-bridge and the PWM output now */
+static volatile DcMotor_State g_direction = STOP;
+static volatile uint8 g_duty = 0;
+
+static volatile DcMotor_RampState g_rampState = DC_MOTOR_IDLE;
+static const uint8 * volatile g_curve;
+static volatile uint8 g_points;
+static volatile uint8 g_point;
+static volatile uint8 g_stepMs;
+static volatile uint8 g_stepMsLeft;
+static volatile uint8 g_rampFrom;
+static volatile uint8 g_rampTo;
+
+/* filtered current in ADC counts << DC_MOTOR_CURRENT_FILTER_SHIFT, and the stall detector */
+static volatile uint16 g_current = 0;
+static volatile uint16 g_runMs = 0;
+static volatile uint8 g_overCurrentMs = 0;
+static volatile boolean g_isStalled = FALSE;
+
+/*******************************************************************************
+ *                      Private Functions                                  *
+ *******************************************************************************/
+
+/* drive the two inputs of the H-bridge */
+static void DcMotor_setBridge(DcMotor_State state)
+{
+	switch (state)
+	{
+	case CW:
+		GPIO_writePin(DC_MOTOR_IN1_PORT_ID,DC_MOTOR_IN1_PIN_ID,LOGIC_HIGH);
+		GPIO_writePin(DC_MOTOR_IN2_PORT_ID,DC_MOTOR_IN2_PIN_ID,LOGIC_LOW);
+		break;
+	case A_CW:
+		GPIO_writePin(DC_MOTOR_IN1_PORT_ID,DC_MOTOR_IN1_PIN_ID,LOGIC_LOW);
+		GPIO_writePin(DC_MOTOR_IN2_PORT_ID,DC_MOTOR_IN2_PIN_ID,LOGIC_HIGH);
+		break;
+	case STOP:
+	default:
+		GPIO_writePin(DC_MOTOR_IN1_PORT_ID,DC_MOTOR_IN1_PIN_ID,LOGIC_LOW);
+		GPIO_writePin(DC_MOTOR_IN2_PORT_ID,DC_MOTOR_IN2_PIN_ID,LOGIC_LOW);
+		break;
+	}
+}
+
+/* ramp from the present duty to the target along a curve, called with the tick interrupt masked */
+static void DcMotor_startRamp(uint8 target,const uint8 *curve,uint8 points,uint8 stepMs)
+{
+	g_rampFrom = g_duty;
+	g_rampTo = target;
+	g_curve = curve;
+	g_points = points;
+	g_point = 0;
+	g_stepMs = stepMs;
+	g_stepMsLeft = stepMs;
+	g_rampState = DC_MOTOR_RAMP;
+}
+
+/* take the next step toward the requested state, called with the tick interrupt masked */
+static void DcMotor_next(void)
+{
+	/* stop or reverse: ramp down, release the bridge, then wait the dead time for a reversal */
+	if((g_direction != STOP) && (g_direction != g_requestState))
+	{
+		if(g_duty != 0)
+		{
+			DcMotor_startRamp(0,g_decelCurve,sizeof(g_decelCurve),DC_MOTOR_DECEL_STEP_MS);
+			return;
+		}
+		DcMotor_setBridge(STOP);
+		g_direction = STOP;
+		ADC_stop();
+		if(g_requestState != STOP)
+		{
+			g_stepMsLeft = DC_MOTOR_DEAD_TIME_MS;
+			g_rampState = DC_MOTOR_DEAD_TIME;
+			return;
+		}
+	}
+
+	if(g_requestState == STOP)
+	{
+		g_rampState = DC_MOTOR_IDLE;
+		return;
+	}
+
+	if(g_direction == STOP)
+	{
+		DcMotor_setBridge(g_requestState);
+		g_direction = g_requestState;
+		g_runMs = 0;
+		g_overCurrentMs = 0;
+		/* the current is only sampled while the bridge drives the motor */
+		ADC_start();
+	}
+
+	if(g_requestSpeed > g_duty)
+	{
+		DcMotor_startRamp(g_requestSpeed,g_accelCurve,sizeof(g_accelCurve),DC_MOTOR_ACCEL_STEP_MS);
+	}
+	else if(g_requestSpeed < g_duty)
+	{
+		DcMotor_startRamp(g_requestSpeed,g_decelCurve,sizeof(g_decelCurve),DC_MOTOR_DECEL_STEP_MS);
+	}
+	else
+	{
+		g_rampState = DC_MOTOR_IDLE;
+	}
+}
+
+/* filter the current samples of the last millisecond and cut a stalled motor */
+static void DcMotor_senseCurrent(void)
+{
+	uint16 sample;
+
+	while(ADC_getSample(&sample) == SUCCESS)
+	{
+		/* fixed point IIR: g_current keeps DC_MOTOR_CURRENT_FILTER_SHIFT fraction bits */
+		g_current = g_current - (g_current >> DC_MOTOR_CURRENT_FILTER_SHIFT) + sample;
+	}
+
+	if(g_direction == STOP)
+	{
+		return;
+	}
+	/* the start current of the motor is not a stall */
+	if(g_runMs < DC_MOTOR_STALL_BLANKING_MS)
+	{
+		g_runMs++;
+		return;
+	}
+	if((g_current >> DC_MOTOR_CURRENT_FILTER_SHIFT) < DC_MOTOR_STALL_CURRENT)
+	{
+		g_overCurrentMs = 0;
+		return;
+	}
+	g_overCurrentMs++;
+	if(g_overCurrentMs >= DC_MOTOR_STALL_CONFIRM_MS)
+	{
+		DcMotor_stopNow();
+		g_isStalled = TRUE;
+	}
+}
+
+/* this function is executed each 1 millisecond from the tick interrupt */
+static void DcMotor_tick(void)
+{
+	sint16 delta;
+
+	DcMotor_senseCurrent();
+
+	if(g_rampState == DC_MOTOR_IDLE)
+	{
+		return;
+	}
+
+	g_stepMsLeft--;
+	if(g_stepMsLeft != 0)
+	{
+		return;
+	}
+
+	if(g_rampState == DC_MOTOR_RAMP)
+	{
+		/* next point of the curve */
+		delta = (sint16)g_rampTo - (sint16)g_rampFrom;
+		g_duty = (uint8)((sint16)g_rampFrom + (delta * (sint16)pgm_read_byte(&g_curve[g_point])) / 100);
+		PWM_setDuty(g_duty);
+		g_point++;
+		if(g_point < g_points)
+		{
+			g_stepMsLeft = g_stepMs;
+			return;
+		}
+	}
+
+	/* end of the ramp or of the dead time */
+	DcMotor_next();
+}
 
 /*******************************************************************************
  *                      Functions Definitions                                  *
@@ -19,6 +225,7 @@
  * The Function responsible for setup the direction for the two
    motor pins through the GPIO driver.
  * Stop at the DC-Motor at the beginning through the GPIO driver..
+ * Hook the ramp engine and the current sensing on the 1ms tick, Tick_init must be called first.
  */
 void DcMotor_Init(void)
 {
@@ -28,40 +235,90 @@ void DcMotor_Init(void)
 	/* Stop at the DC-Motor at the beginning through the GPIO driver */
 	GPIO_writePin(DC_MOTOR_IN1_PORT_ID,DC_MOTOR_IN1_PIN_ID,LOGIC_LOW);
 	GPIO_writePin(DC_MOTOR_IN2_PORT_ID,DC_MOTOR_IN2_PIN_ID,LOGIC_LOW);
+	/* the PWM is set up once, the ramps only change the duty cycle */
+	PWM_ConfigType pwm_config={DC_MOTOR_PWM_MODE,DC_MOTOR_PWM_PRESCALER};
+	PWM_init(&pwm_config);
+	/* the current sense pin is sampled in the background while the motor runs */
+	GPIO_setupPinDirection(PORTA_ID,DC_MOTOR_CURRENT_ADC_CHANNEL,PIN_INPUT);
+	ADC_ConfigType adc_config={ADC_AVCC,ADC_PRESCALE_128,DC_MOTOR_CURRENT_ADC_CHANNEL};
+	ADC_init(&adc_config);
+	Tick_addCallBack(DcMotor_tick);
 }
 
 /*
  * Description
  * The function responsible for rotate the DC Motor CW/ or A-CW or
    stop the motor based on the state input state value.
- * Send the required duty cycle to the PWM driver based on the required speed value
+ * The speed is reached along the acceleration or deceleration curve in the background,
+   a reversal first ramps down to 0 and waits the dead time. The function returns at once.
  */
 void DcMotor_Rotate(DcMotor_State state,uint8 speed)
 {
-	/*rotate the DC Motor CW/ or A-CW or stop the motor based on the state*/
-	switch (state)
+	uint8 sreg = SREG;
+
+	cli();
+	g_requestState = state;
+	g_requestSpeed = (state == STOP) ? 0 : speed;
+	g_isStalled = FALSE;
+	/* a running ramp is turned toward the new target from the present duty,
+	   the dead time is always waited to the end */
+	if(g_rampState != DC_MOTOR_DEAD_TIME)
 	{
-	case STOP:
-		GPIO_writePin(DC_MOTOR_IN1_PORT_ID,DC_MOTOR_IN1_PIN_ID,LOGIC_LOW);
-		GPIO_writePin(DC_MOTOR_IN2_PORT_ID,DC_MOTOR_IN2_PIN_ID,LOGIC_LOW);
-		break;
-	case CW:
-		GPIO_writePin(DC_MOTOR_IN1_PORT_ID,DC_MOTOR_IN1_PIN_ID,LOGIC_HIGH);
-		GPIO_writePin(DC_MOTOR_IN2_PORT_ID,DC_MOTOR_IN2_PIN_ID,LOGIC_LOW);
-		break;
-	case A_CW:
-		GPIO_writePin(DC_MOTOR_IN1_PORT_ID,DC_MOTOR_IN1_PIN_ID,LOGIC_LOW);
-		GPIO_writePin(DC_MOTOR_IN2_PORT_ID,DC_MOTOR_IN2_PIN_ID,LOGIC_HIGH);
-		break;
-	default:
-		GPIO_writePin(DC_MOTOR_IN1_PORT_ID,DC_MOTOR_IN1_PIN_ID,LOGIC_LOW);
-		GPIO_writePin(DC_MOTOR_IN2_PORT_ID,DC_MOTOR_IN2_PIN_ID,LOGIC_LOW);
-		break;
+		DcMotor_next();
 	}
-	//send the speed to PWM function
-	PWM_Timer0_Start(speed);
+	SREG = sreg;
 }
 
+/*
+ * Description
+ * Return TRUE while a ramp or the dead time is running.
+ */
+boolean DcMotor_isRamping(void)
+{
+	return (g_rampState != DC_MOTOR_IDLE);
+}
 
+/*
+ * Description
+ * Stop the DC Motor at once without the deceleration ramp, used when an end position
+   is reached. It is safe to call from an ISR.
+ */
+void DcMotor_stopNow(void)
+{
+	uint8 sreg = SREG;
 
+	cli();
+	g_requestState = STOP;
+	g_requestSpeed = 0;
+	g_rampState = DC_MOTOR_IDLE;
+	g_duty = 0;
+	PWM_setDuty(0);
+	DcMotor_setBridge(STOP);
+	g_direction = STOP;
+	ADC_stop();
+	SREG = sreg;
+}
 
+/*
+ * Description
+ * Return TRUE if the motor was cut because it stalled, cleared by the next DcMotor_Rotate.
+ */
+boolean DcMotor_isStalled(void)
+{
+	return g_isStalled;
+}
+
+/*
+ * Description
+ * Return the filtered motor current in ADC counts.
+ */
+uint16 DcMotor_getCurrent(void)
+{
+	uint16 current;
+	uint8 sreg = SREG;
+
+	cli();
+	current = g_current >> DC_MOTOR_CURRENT_FILTER_SHIFT;
+	SREG = sreg;
+	return current;
+}
@@ -15,6 +15,37 @@
 #define DC_MOTOR_IN2_PORT_ID              PORTB_ID
 #define DC_MOTOR_IN2_PIN_ID               PIN1_ID
 
+/*
+ * Time between two points of the ramp curves (tables in dc_motor.c),
+ * 16 points of 25ms give a 400ms soft start and 10 points a 250ms soft stop
+ */
+#define DC_MOTOR_ACCEL_STEP_MS            25
+#define DC_MOTOR_DECEL_STEP_MS            25
+
+/* Phase correct PWM without prescaling: 15.7KHz, above the audible range,
+   and a duty of 0 gives no output pulse at all */
+#define DC_MOTOR_PWM_MODE                 PWM_PHASE_CORRECT_MODE
+#define DC_MOTOR_PWM_PRESCALER            PWM_NO_PRESCALING
+
+/* Both inputs are kept low for this time before the direction is reversed */
+#define DC_MOTOR_DEAD_TIME_MS             50
+
+/*
+ * Current sense resistor of the H-bridge on ADC1 (PA1), AVCC reference:
+ * one ADC count is 4.9mV, so 9.8mA with a 0.5 ohm resistor.
+ * The samples go through an IIR filter y += (x - y)/8 (time constant about 1.7ms).
+ */
+#define DC_MOTOR_CURRENT_ADC_CHANNEL      1
+#define DC_MOTOR_CURRENT_FILTER_SHIFT     3
+
+/*
+ * Stall: the filtered current stays over the threshold (about 1.2A) for the confirm time.
+ * It is not checked during the blanking time after the motor is started.
+ */
+#define DC_MOTOR_STALL_CURRENT            122
+#define DC_MOTOR_STALL_CONFIRM_MS         5
+#define DC_MOTOR_STALL_BLANKING_MS        100
+
 
 /*******************************************************************************
  *                         Types Declaration                                   *
@@ -33,6 +64,7 @@ typedef enum
 Description
  * The Function responsible for setup the direction for the two motor pins through the GPIO driver.
  * Stop at the DC-Motor at the beginning through the GPIO driver..
+ * Hook the ramp engine and the current sensing on the 1ms tick, Tick_init must be called first.
  */
 void DcMotor_Init(void);
 
@@ -40,9 +72,35 @@ void DcMotor_Init(void);
  * Description
  * The function responsible for rotate the DC Motor CW/ or A-CW or
    stop the motor based on the state input state value.
- * Send the required duty cycle to the PWM driver based on the required speed value
+ * The speed is reached along the acceleration or deceleration curve in the background,
+   a reversal first ramps down to 0 and waits the dead time. The function returns at once.
  */
 void DcMotor_Rotate(DcMotor_State state,uint8 speed);
 
+/*
+ * Description
+ * Return TRUE while a ramp or the dead time is running.
+ */
+boolean DcMotor_isRamping(void);
+
+/*
+ * Description
+ * Stop the DC Motor at once without the deceleration ramp, used when an end position
+   is reached. It is safe to call from an ISR.
+ */
+void DcMotor_stopNow(void);
+
+/*
+ * Description
+ * Return TRUE if the motor was cut because it stalled, cleared by the next DcMotor_Rotate.
+ */
+boolean DcMotor_isStalled(void);
+
+/*
+ * Description
+ * Return the filtered motor current in ADC counts.
+ */
+uint16 DcMotor_getCurrent(void);
+
 
 #endif /* DC_MOTOR_H_ */
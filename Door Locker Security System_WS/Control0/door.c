@@ -0,0 +1,179 @@
+ /******************************************************************************
+ *
+ * Module: Door
+ *
+ * File Name: door.c
+ *
+ * Description: Source file for the closed loop door travel with end switches
+ *
+ *******************************************************************************/
+
+#include "avr/io.h"
+#include "door.h"
+#include "common_macros.h"
+#include "gpio.h"
+#include "dc_motor.h"
+#include "tick.h"
+#include <avr/interrupt.h>
+
+static volatile Door_Status g_status = DOOR_AT_END;
+static volatile Door_Direction g_direction = DOOR_CLOSE;
+static volatile uint32 g_startMs = 0;
+static volatile uint32 g_endMs = 0;
+#if DOOR_USE_ENCODER
+static volatile uint16 g_pulses = 0;
+static volatile uint32 g_lastPulseMs = 0;
+#endif
+
+/*******************************************************************************
+ *                      Private Functions                                  *
+ *******************************************************************************/
+
+/* stop the travel with its result, called with the interrupts masked */
+static void Door_end(Door_Status status)
+{
+	DcMotor_stopNow();
+	g_endMs = Tick_getMs();
+	g_status = status;
+}
+
+/* return TRUE if the end switch of a direction is closed */
+static boolean Door_isAtEnd(Door_Direction direction)
+{
+	if(direction == DOOR_OPEN)
+	{
+		return (GPIO_readPin(DOOR_OPEN_SWITCH_PORT_ID,DOOR_OPEN_SWITCH_PIN_ID) == LOGIC_LOW);
+	}
+	return (GPIO_readPin(DOOR_CLOSED_SWITCH_PORT_ID,DOOR_CLOSED_SWITCH_PIN_ID) == LOGIC_LOW);
+}
+
+/*******************************************************************************
+ *                              ISR                                    *
+ *******************************************************************************/
+
+/* open position reached */
+ISR(INT0_vect)
+{
+	if((g_status == DOOR_MOVING) && (g_direction == DOOR_OPEN))
+	{
+		Door_end(DOOR_AT_END);
+	}
+}
+
+/* closed position reached */
+ISR(INT1_vect)
+{
+	if((g_status == DOOR_MOVING) && (g_direction == DOOR_CLOSE))
+	{
+		Door_end(DOOR_AT_END);
+	}
+}
+
+#if DOOR_USE_ENCODER
+/* one encoder pulse, the full travel is also an end position */
+ISR(INT2_vect)
+{
+	if(g_status != DOOR_MOVING)
+	{
+		return;
+	}
+	g_lastPulseMs = Tick_getMs();
+	g_pulses++;
+	if(g_pulses >= DOOR_TRAVEL_PULSES)
+	{
+		Door_end(DOOR_AT_END);
+	}
+}
+#endif
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void Door_init(void)
+{
+	/* inputs with the internal pull-up, a closed switch reads low */
+	GPIO_setupPinDirection(DOOR_OPEN_SWITCH_PORT_ID,DOOR_OPEN_SWITCH_PIN_ID,PIN_INPUT);
+	GPIO_writePin(DOOR_OPEN_SWITCH_PORT_ID,DOOR_OPEN_SWITCH_PIN_ID,LOGIC_HIGH);
+	GPIO_setupPinDirection(DOOR_CLOSED_SWITCH_PORT_ID,DOOR_CLOSED_SWITCH_PIN_ID,PIN_INPUT);
+	GPIO_writePin(DOOR_CLOSED_SWITCH_PORT_ID,DOOR_CLOSED_SWITCH_PIN_ID,LOGIC_HIGH);
+
+	/* INT0 and INT1 on the falling edge: ISC01=1 ISC00=0, ISC11=1 ISC10=0 */
+	MCUCR = (MCUCR & 0xF0) | (1<<ISC01) | (1<<ISC11);
+	SET_BIT(GICR,INT0);
+	SET_BIT(GICR,INT1);
+
+#if DOOR_USE_ENCODER
+	GPIO_setupPinDirection(DOOR_ENCODER_PORT_ID,DOOR_ENCODER_PIN_ID,PIN_INPUT);
+	/* INT2 on the rising edge, ISC2 is changed with INT2 disabled as the datasheet asks */
+	CLEAR_BIT(GICR,INT2);
+	SET_BIT(MCUCSR,ISC2);
+	SET_BIT(GIFR,INTF2);
+	SET_BIT(GICR,INT2);
+#endif
+}
+
+void Door_move(Door_Direction direction)
+{
+	uint8 sreg = SREG;
+
+	cli();
+	g_direction = direction;
+	g_startMs = Tick_getMs();
+	g_endMs = g_startMs;
+#if DOOR_USE_ENCODER
+	g_pulses = 0;
+	g_lastPulseMs = g_startMs;
+#endif
+	/* already there: the edge of the switch will never come */
+	if(Door_isAtEnd(direction))
+	{
+		g_status = DOOR_AT_END;
+	}
+	else
+	{
+		g_status = DOOR_MOVING;
+		DcMotor_Rotate((direction == DOOR_OPEN) ? CW : A_CW,DOOR_SPEED);
+	}
+	SREG = sreg;
+}
+
+Door_Status Door_getStatus(void)
+{
+	uint8 sreg = SREG;
+	uint32 now;
+
+	cli();
+	if(g_status == DOOR_MOVING)
+	{
+		now = Tick_getMs();
+		/* the motor current sensing already cut a blocked bolt */
+		if(DcMotor_isStalled())
+		{
+			Door_end(DOOR_JAMMED);
+		}
+		else if((now - g_startMs) >= DOOR_TRAVEL_TIMEOUT_MS)
+		{
+			Door_end(DOOR_JAMMED);
+		}
+#if DOOR_USE_ENCODER
+		else if((now - g_lastPulseMs) >= DOOR_STALL_MS)
+		{
+			Door_end(DOOR_JAMMED);
+		}
+#endif
+	}
+	SREG = sreg;
+	return g_status;
+}
+
+uint32 Door_getTravelMs(void)
+{
+	uint32 ms;
+	uint8 sreg = SREG;
+
+	cli();
+	ms = ((g_status == DOOR_MOVING) ? Tick_getMs() : g_endMs) - g_startMs;
+	SREG = sreg;
+	return ms;
+}
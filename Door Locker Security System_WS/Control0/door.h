@@ -0,0 +1,89 @@
+ /******************************************************************************
+ *
+ * Module: Door
+ *
+ * File Name: door.h
+ *
+ * Description: Header file for the closed loop door travel with end switches
+ *
+ *******************************************************************************/
+
+#ifndef DOOR_H_
+#define DOOR_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/*
+ * End switches, closed to ground at the end position (internal pull-up):
+ * open position on INT0 (PD2), closed position on INT1 (PD3).
+ */
+#define DOOR_OPEN_SWITCH_PORT_ID      PORTD_ID
+#define DOOR_OPEN_SWITCH_PIN_ID       PIN2_ID
+#define DOOR_CLOSED_SWITCH_PORT_ID    PORTD_ID
+#define DOOR_CLOSED_SWITCH_PIN_ID     PIN3_ID
+
+/*
+ * Optional encoder on INT2 (PB2), one pulse per rising edge. The travel also ends
+ * after DOOR_TRAVEL_PULSES pulses, and no pulse for DOOR_STALL_MS is a jam.
+ */
+#define DOOR_USE_ENCODER              0
+#define DOOR_ENCODER_PORT_ID          PORTB_ID
+#define DOOR_ENCODER_PIN_ID           PIN2_ID
+#define DOOR_TRAVEL_PULSES            600
+#define DOOR_STALL_MS                 500
+
+/* Safety cap: a travel not finished after the old fixed run time is a jam */
+#define DOOR_TRAVEL_TIMEOUT_MS        15000UL
+
+#define DOOR_SPEED                    100
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef enum
+{
+	DOOR_OPEN,DOOR_CLOSE
+}Door_Direction;
+
+typedef enum
+{
+	DOOR_MOVING,DOOR_AT_END,DOOR_JAMMED
+}Door_Status;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Setup the end switch (and encoder) pins and their external interrupts.
+ * Must be called after Tick_init and DcMotor_Init.
+ */
+void Door_init(void);
+
+/*
+ * Description :
+ * Start the motor toward the open or the closed position and return at once.
+ * The motor is stopped by the end switch interrupt as soon as the position is reached.
+ */
+void Door_move(Door_Direction direction);
+
+/*
+ * Description :
+ * Return the state of the last travel. A travel cut by the motor stall detection,
+ * over the timeout, or without encoder pulses, is stopped and reported as DOOR_JAMMED.
+ */
+Door_Status Door_getStatus(void);
+
+/*
+ * Description :
+ * Return the duration in ms of the last travel, or of the running one.
+ */
+uint32 Door_getTravelMs(void);
+
+#endif /* DOOR_H_ */
@@ -11,28 +11,38 @@
 #include "external_eeprom.h"
 #include "twi.h"
 
+/* Descriptor and buffer (memory address + page data) of the asynchronous block transfers */
+static TWI_TransferType g_eepromTransfer;
+static uint8 g_eepromBuffer[1 + EEPROM_PAGE_SIZE];
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static uint8 EEPROM_abort(void);
+
 uint8 EEPROM_writeByte(uint16 u16addr, uint8 u8data)
 {
 	/* Send the Start Bit */
     TWI_start();
     if (TWI_getStatus() != TWI_START)
-        return ERROR;
+        return EEPROM_abort();
 		
     /* Send the device address, we need to get A8 A9 A10 address bits from the
      * memory location address and R/W=0 (write) */
     TWI_writeByte((uint8)(0xA0 | ((u16addr & 0x0700)>>7)));
     if (TWI_getStatus() != TWI_MT_SLA_W_ACK)
-        return ERROR; 
+        return EEPROM_abort(); 
 		 
     /* Send the required memory location address */
     TWI_writeByte((uint8)(u16addr));
     if (TWI_getStatus() != TWI_MT_DATA_ACK)
-        return ERROR;
+        return EEPROM_abort();
 		
     /* write byte to eeprom */
     TWI_writeByte(u8data);
     if (TWI_getStatus() != TWI_MT_DATA_ACK)
-        return ERROR;
+        return EEPROM_abort();
 
     /* Send the Stop Bit */
     TWI_stop();
@@ -45,37 +55,184 @@ uint8 EEPROM_readByte(uint16 u16addr, uint8 *u8data)
 	/* Send the Start Bit */
     TWI_start();
     if (TWI_getStatus() != TWI_START)
-        return ERROR;
+        return EEPROM_abort();
 		
     /* Send the device address, we need to get A8 A9 A10 address bits from the
      * memory location address and R/W=0 (write) */
     TWI_writeByte((uint8)((0xA0) | ((u16addr & 0x0700)>>7)));
     if (TWI_getStatus() != TWI_MT_SLA_W_ACK)
-        return ERROR;
+        return EEPROM_abort();
 		
     /* Send the required memory location address */
     TWI_writeByte((uint8)(u16addr));
     if (TWI_getStatus() != TWI_MT_DATA_ACK)
-        return ERROR;
+        return EEPROM_abort();
 		
     /* Send the Repeated Start Bit */
     TWI_start();
     if (TWI_getStatus() != TWI_REP_START)
-        return ERROR;
+        return EEPROM_abort();
 		
     /* Send the device address, we need to get A8 A9 A10 address bits from the
      * memory location address and R/W=1 (Read) */
     TWI_writeByte((uint8)((0xA0) | ((u16addr & 0x0700)>>7) | 1));
     if (TWI_getStatus() != TWI_MT_SLA_R_ACK)
-        return ERROR;
+        return EEPROM_abort();
 
     /* Read Byte from Memory without send ACK */
     *u8data = TWI_readByteWithNACK();
     if (TWI_getStatus() != TWI_MR_DATA_NACK)
-        return ERROR;
+        return EEPROM_abort();
 
     /* Send the Stop Bit */
     TWI_stop();
 
     return SUCCESS;
 }
+
+uint8 EEPROM_writeBlockAsync(uint16 u16addr, const uint8 *data, uint8 length, void(*a_ptr)(TWI_TransferStatus))
+{
+    if ((length == 0) || (length > EEPROM_PAGE_SIZE) || (EEPROM_isBusy()))
+        return ERROR;
+
+    /* The memory rolls over inside the page, so the block must not cross it */
+    if (((u16addr % EEPROM_PAGE_SIZE) + length) > EEPROM_PAGE_SIZE)
+        return ERROR;
+
+    /* First byte is the memory location address followed by the data */
+    g_eepromBuffer[0] = (uint8)(u16addr);
+    for (uint8 i = 0; i < length; i++)
+    {
+        g_eepromBuffer[i + 1] = data[i];
+    }
+
+    g_eepromTransfer.slave_address = EEPROM_DEVICE_ADDRESS | ((u16addr & 0x0700) >> 8);
+    g_eepromTransfer.write_data = g_eepromBuffer;
+    g_eepromTransfer.write_length = length + 1;
+    g_eepromTransfer.read_data = NULL_PTR;
+    g_eepromTransfer.read_length = 0;
+    g_eepromTransfer.callBack = a_ptr;
+
+    if (!TWI_startTransfer(&g_eepromTransfer))
+        return ERROR;
+
+    return SUCCESS;
+}
+
+uint8 EEPROM_readBlockAsync(uint16 u16addr, uint8 *data, uint8 length, void(*a_ptr)(TWI_TransferStatus))
+{
+    if ((length == 0) || (EEPROM_isBusy()))
+        return ERROR;
+
+    g_eepromBuffer[0] = (uint8)(u16addr);
+
+    g_eepromTransfer.slave_address = EEPROM_DEVICE_ADDRESS | ((u16addr & 0x0700) >> 8);
+    g_eepromTransfer.write_data = g_eepromBuffer;
+    g_eepromTransfer.write_length = 1;
+    g_eepromTransfer.read_data = data;
+    g_eepromTransfer.read_length = length;
+    g_eepromTransfer.callBack = a_ptr;
+
+    if (!TWI_startTransfer(&g_eepromTransfer))
+        return ERROR;
+
+    return SUCCESS;
+}
+
+boolean EEPROM_isBusy(void)
+{
+    return (TWI_getTransferStatus() == TWI_TRANSFER_BUSY);
+}
+
+uint8 EEPROM_waitReady(void)
+{
+    TWI_TransferType probe = {EEPROM_DEVICE_ADDRESS, NULL_PTR, 0, NULL_PTR, 0, NULL_PTR};
+    uint16 retries = EEPROM_ACK_POLLING_RETRIES;
+
+    /* Address only transfers until the memory ACKs */
+    do
+    {
+        TWI_waitTransfer();
+        if (!TWI_startTransfer(&probe))
+            return ERROR;
+        retries--;
+    } while ((TWI_waitTransfer() == TWI_TRANSFER_NACK) && (retries != 0));
+
+    return (TWI_getTransferStatus() == TWI_TRANSFER_DONE) ? SUCCESS : ERROR;
+}
+
+uint8 EEPROM_writeBlock(uint16 u16addr, const uint8 *data, uint16 length)
+{
+    uint8 chunk;
+    uint16 retries;
+
+    while (length > 0)
+    {
+        /* Write up to the end of the current page */
+        chunk = EEPROM_PAGE_SIZE - (u16addr % EEPROM_PAGE_SIZE);
+        if (chunk > length)
+            chunk = (uint8)length;
+
+        /* The memory NACKs its address until the previous write cycle is finished */
+        retries = EEPROM_ACK_POLLING_RETRIES;
+        do
+        {
+            TWI_waitTransfer();
+            if (EEPROM_writeBlockAsync(u16addr, data, chunk, NULL_PTR) == ERROR)
+                return ERROR;
+            retries--;
+        } while ((TWI_waitTransfer() == TWI_TRANSFER_NACK) && (retries != 0));
+
+        if (TWI_getTransferStatus() != TWI_TRANSFER_DONE)
+            return ERROR;
+
+        u16addr += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+
+    return SUCCESS;
+}
+
+uint8 EEPROM_readBlock(uint16 u16addr, uint8 *data, uint16 length)
+{
+    uint8 chunk;
+    uint16 retries;
+
+    while (length > 0)
+    {
+        /* The transfer descriptor length is 8 bits */
+        chunk = (length > 0xFF) ? 0xFF : (uint8)length;
+
+        retries = EEPROM_ACK_POLLING_RETRIES;
+        do
+        {
+            TWI_waitTransfer();
+            if (EEPROM_readBlockAsync(u16addr, data, chunk, NULL_PTR) == ERROR)
+                return ERROR;
+            retries--;
+        } while ((TWI_waitTransfer() == TWI_TRANSFER_NACK) && (retries != 0));
+
+        if (TWI_getTransferStatus() != TWI_TRANSFER_DONE)
+            return ERROR;
+
+        u16addr += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+
+    return SUCCESS;
+}
+
+/*
+ * Description :
+ * Leave the bus after a failed byte access: send the stop bit, and recover the
+ * bus if it does not respond any more (timeout or bus error).
+ */
+static uint8 EEPROM_abort(void)
+{
+    if ((TWI_getError() != TWI_ERROR_NONE) || (TWI_stop() != TWI_ERROR_NONE))
+        TWI_recoverBus();
+
+    return ERROR;
+}
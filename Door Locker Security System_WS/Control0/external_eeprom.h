@@ -14,6 +14,7 @@
 #define EXTERNAL_EEPROM_H_
 
 #include "std_types.h"
+#include "twi.h"
 
 /*******************************************************************************
  *                      Preprocessor Macros                                    *
@@ -21,11 +22,60 @@
 #define ERROR 0
 #define SUCCESS 1
 
+/* 24C16 memory: 2 Kbytes in 16 bytes pages, A8 A9 A10 are sent inside the device address */
+#define EEPROM_DEVICE_ADDRESS        0x50
+#define EEPROM_SIZE                  2048
+#define EEPROM_PAGE_SIZE             16
+
+/* Number of ACK polls while the memory is busy in its internal write cycle (about 10ms) */
+#define EEPROM_ACK_POLLING_RETRIES   500
+
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
 
 uint8 EEPROM_writeByte(uint16 u16addr,uint8 u8data);
 uint8 EEPROM_readByte(uint16 u16addr,uint8 *u8data);
+
+/*
+ * Description :
+ * Start writing up to EEPROM_PAGE_SIZE bytes inside one page using the interrupt driven TWI
+ * and return immediately, the data is copied so the caller buffer can be reused at once.
+ * Return ERROR if the TWI is busy or the block crosses a page boundary.
+ */
+uint8 EEPROM_writeBlockAsync(uint16 u16addr,const uint8 *data,uint8 length,void(*a_ptr)(TWI_TransferStatus));
+
+/*
+ * Description :
+ * Start reading a block of sequential bytes using the interrupt driven TWI and return immediately.
+ * The data buffer must stay valid until the call back is called or EEPROM_isBusy() returns FALSE.
+ */
+uint8 EEPROM_readBlockAsync(uint16 u16addr,uint8 *data,uint8 length,void(*a_ptr)(TWI_TransferStatus));
+
+/*
+ * Description :
+ * Return TRUE while an asynchronous block transfer is running.
+ */
+boolean EEPROM_isBusy(void);
+
+/*
+ * Description :
+ * Wait for the end of the internal write cycle by ACK polling the memory,
+ * so an asynchronous transfer can be started without being NACKed.
+ */
+uint8 EEPROM_waitReady(void);
+
+/*
+ * Description :
+ * Write a block of any length, split into page writes, and wait for it.
+ * The memory is ACK polled while it finishes the internal write cycle of the previous page.
+ */
+uint8 EEPROM_writeBlock(uint16 u16addr,const uint8 *data,uint16 length);
+
+/*
+ * Description :
+ * Read a block of sequential bytes and wait for it.
+ */
+uint8 EEPROM_readBlock(uint16 u16addr,uint8 *data,uint16 length);
  
 #endif /* EXTERNAL_EEPROM_H_ */
@@ -0,0 +1,54 @@
+ /******************************************************************************
+ *
+ * Module: Idle
+ *
+ * File Name: idle.h
+ *
+ * Description: Header file for the idle sleep of the ECU
+ *
+ *******************************************************************************/
+
+#ifndef IDLE_H_
+#define IDLE_H_
+
+#include "std_types.h"
+
+/*
+ * Idle sleep stops only the CPU clock: the timers, the UART, the TWI, the ADC and the
+ * external interrupts keep running and any of their interrupts wakes the CPU.
+ * Power-save and power-down would stop the UART clock and the synchronous Timer2,
+ * so they cannot be used while the ECU waits for a byte or a tick.
+ *
+ * Estimated supply current of the ATmega32 at 8MHz and 5V, not measured: the datasheet
+ * typical values (about 11mA active, about 4mA asleep in idle) weighted by the part of
+ * the time the CPU is awake, I = 4mA + awake * (11mA - 4mA). The cycle counts are
+ * estimates for the -Os build, the -O0 Debug build stays awake about twice as long.
+ *   busy wait (before the idle sleep)                            about 11mA
+ *   waiting, motor stopped: 1ms Timer2 tick wakes the CPU, the tick
+ *   callbacks and one pass of the main loop take about 1000 of the
+ *   8000 cycles of each ms (awake 12%), the ADC is off              about 4.9mA
+ *   door moving: the tick plus the ADC conversion interrupt each
+ *   208us (4.8kHz, about 150 cycles with the wait loop, awake 9%)
+ *   and the converter itself (a few hundred uA)                   about 5.8mA, motor apart
+ */
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Select the idle sleep mode.
+ */
+void Idle_init(void);
+
+/*
+ * Description :
+ * Sleep until the next interrupt. It must be called with the interrupts disabled,
+ * right after checking there is nothing to do: the interrupts are enabled by the
+ * instruction just before the sleep so a wake-up in between cannot be missed.
+ * It returns with the interrupts enabled.
+ */
+void Idle_sleep(void);
+
+#endif /* IDLE_H_ */
@@ -0,0 +1,285 @@
+ /******************************************************************************
+ *
+ * Module: Link
+ *
+ * File Name: link.c
+ *
+ * Description: Source file for the encrypted and authenticated HMI <-> Control frames
+ *
+ *******************************************************************************/
+
+#include "link.h"
+#include "siphash.h"
+#include "storage.h"
+#include "uart.h"
+#include "cycles.h"
+#include <util/crc16.h>
+
+#define LINK_DIRECTION_BIT           0x80000000UL
+
+static uint8 g_key[CHACHA_KEY_SIZE] = LINK_DEFAULT_KEY;
+static uint32 g_direction = 0;
+static uint32 g_bootCounter = 0;
+static uint32 g_sendCounter = 0;
+/* Newest frame accepted from the other side */
+static uint32 g_peerBoot = 0;
+static uint32 g_peerCounter = 0;
+static boolean g_hasPeerFrame = FALSE;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void Link_seal(const uint8 *header,uint8 *payload,uint8 length,uint8 *tag);
+static uint32 Link_load(const uint8 *bytes);
+static void Link_store(uint8 *bytes,uint32 word);
+static void Link_savePeerBoot(uint32 boot);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void Link_init(Link_Role role)
+{
+	uint8 record[CHACHA_KEY_SIZE + 1];
+	uint8 counter[4];
+	uint8 crc = 0;
+
+	g_direction = (role == LINK_CONTROL) ? LINK_DIRECTION_BIT : 0;
+
+	/* the provisioned key, the development one stays if there is none */
+	if(Storage_read(STORAGE_LINK, LINK_KEY_OFFSET, record, sizeof(record)) == SUCCESS)
+	{
+		for(uint8 i = 0; i < CHACHA_KEY_SIZE; i++)
+		{
+			crc = _crc8_ccitt_update(crc, record[i]);
+		}
+		if(crc == record[CHACHA_KEY_SIZE])
+		{
+			for(uint8 i = 0; i < CHACHA_KEY_SIZE; i++)
+			{
+				g_key[i] = record[i];
+			}
+		}
+	}
+
+	/* a new boot number so the nonces of this boot were never used (only changed bytes are written) */
+	if(Storage_read(STORAGE_LINK, LINK_BOOT_COUNTER_OFFSET, counter, sizeof(counter)) == SUCCESS)
+	{
+		g_bootCounter = Link_load(counter) + 1;
+	}
+	Link_store(counter, g_bootCounter);
+	Storage_write(STORAGE_LINK, LINK_BOOT_COUNTER_OFFSET, counter, sizeof(counter));
+	g_sendCounter = 0;
+	g_hasPeerFrame = FALSE;
+
+	/* every frame of the HMI boots served before the reset is a replay */
+	if(Storage_read(STORAGE_LINK, LINK_PEER_BOOT_OFFSET, record, 5) == SUCCESS)
+	{
+		crc = 0;
+		for(uint8 i = 0; i < 4; i++)
+		{
+			crc = _crc8_ccitt_update(crc, record[i]);
+		}
+		if(crc == record[4])
+		{
+			g_peerBoot = Link_load(record);
+			g_peerCounter = 0xFFFFFFFFUL;
+			g_hasPeerFrame = TRUE;
+		}
+	}
+}
+
+void Link_send(const uint8 *data, uint8 length)
+{
+	uint8 header[LINK_HEADER_SIZE];
+	uint8 payload[LINK_MAX_PAYLOAD];
+	uint8 tag[LINK_TAG_SIZE];
+
+	if(length > LINK_MAX_PAYLOAD)
+	{
+		length = LINK_MAX_PAYLOAD;
+	}
+	Link_store(header, g_bootCounter);
+	Link_store(header + 4, (g_sendCounter & ~LINK_DIRECTION_BIT) | g_direction);
+	g_sendCounter++;
+
+	for(uint8 i = 0; i < length; i++)
+	{
+		payload[i] = data[i];
+	}
+	Link_seal(header, payload, length, tag);
+
+	UART_sendArrayOfByte(header, LINK_HEADER_SIZE);
+	UART_sendArrayOfByte(payload, length);
+	UART_sendArrayOfByte(tag, LINK_TAG_SIZE);
+}
+
+uint8 Link_receive(uint8 *data, uint8 length, uint16 timeout_ms)
+{
+	uint8 frame[LINK_HEADER_SIZE + LINK_MAX_PAYLOAD + LINK_TAG_SIZE];
+	uint8 *header = frame;
+	uint8 *payload = &frame[LINK_HEADER_SIZE];
+	uint8 *tag;
+	uint8 expected[LINK_TAG_SIZE];
+	uint8 difference = 0;
+	uint8 received;
+	uint32 boot;
+	uint32 counter;
+
+	if(length > LINK_MAX_PAYLOAD)
+	{
+		length = LINK_MAX_PAYLOAD;
+	}
+	tag = &frame[LINK_HEADER_SIZE + length];
+
+	/* one deadline for the whole frame, a cut frame is dropped to its end */
+	if(UART_recieveArrayOfByteTimeout(frame, LINK_HEADER_SIZE + length + LINK_TAG_SIZE, timeout_ms, &received) == ERROR)
+	{
+		if(received != 0)
+		{
+			UART_resync();
+		}
+		for(uint8 i = 0; i < length; i++)
+		{
+			data[i] = 0;
+		}
+		return ERROR;
+	}
+
+	/* the tag is computed over the ciphertext, the payload is decrypted by the same xor */
+	Link_seal(header, payload, length, expected);
+	for(uint8 i = 0; i < LINK_TAG_SIZE; i++)
+	{
+		difference |= tag[i] ^ expected[i];
+	}
+
+	boot = Link_load(header);
+	counter = Link_load(header + 4);
+	if((difference != 0) || ((counter & LINK_DIRECTION_BIT) == g_direction) ||
+			(g_hasPeerFrame && ((boot < g_peerBoot) || ((boot == g_peerBoot) && (counter <= g_peerCounter)))))
+	{
+		/* forged, corrupted, reflected or replayed frame */
+		for(uint8 i = 0; i < length; i++)
+		{
+			data[i] = 0;
+		}
+		return ERROR;
+	}
+
+	if((!g_hasPeerFrame) || (boot != g_peerBoot))
+	{
+		Link_savePeerBoot(boot);
+	}
+	g_peerBoot = boot;
+	g_peerCounter = counter;
+	g_hasPeerFrame = TRUE;
+	for(uint8 i = 0; i < length; i++)
+	{
+		data[i] = payload[i];
+	}
+	return SUCCESS;
+}
+
+void Link_deriveKey(uint8 label, uint8 *key, uint8 length)
+{
+	uint8 nonce[LINK_HEADER_SIZE];
+	uint8 block[CHACHA_BLOCK_SIZE];
+
+	for(uint8 i = 0; i < (LINK_HEADER_SIZE - 1); i++)
+	{
+		nonce[i] = 0xFF;
+	}
+	nonce[LINK_HEADER_SIZE - 1] = label;
+	ChaCha_block(g_key, nonce, 1, block);
+	for(uint8 i = 0; (i < length) && (i < CHACHA_BLOCK_SIZE); i++)
+	{
+		key[i] = block[i];
+	}
+}
+
+uint32 Link_measureFrame(void)
+{
+	uint8 header[LINK_HEADER_SIZE];
+	uint8 payload[LINK_MAX_PAYLOAD] = {0};
+	uint8 tag[LINK_TAG_SIZE];
+
+	/* the nonce of boot and message 0xFFFFFFFF, no frame uses it and its output is dropped */
+	for(uint8 i = 0; i < LINK_HEADER_SIZE; i++)
+	{
+		header[i] = 0xFF;
+	}
+	Cycles_start();
+	Link_seal(header, payload, LINK_MAX_PAYLOAD, tag);
+	return Cycles_stop();
+}
+
+/*
+ * Description :
+ * Xor the payload with the keystream of the header nonce and return the tag of the
+ * ciphertext: after the call the payload is encrypted if it was plain (sending)
+ * and plain if it was encrypted (receiving), the tag is computed before or after.
+ */
+static void Link_seal(const uint8 *header, uint8 *payload, uint8 length, uint8 *tag)
+{
+	uint8 block[CHACHA_BLOCK_SIZE];
+	uint8 message[LINK_HEADER_SIZE + LINK_MAX_PAYLOAD];
+	boolean isSending = (Link_load(header + 4) & LINK_DIRECTION_BIT) == g_direction;
+
+	ChaCha_block(g_key, header, 0, block);
+	for(uint8 i = 0; i < LINK_HEADER_SIZE; i++)
+	{
+		message[i] = header[i];
+	}
+	for(uint8 i = 0; i < length; i++)
+	{
+		if(isSending)
+		{
+			payload[i] ^= block[LINK_MAC_KEY_SIZE + i];
+			message[LINK_HEADER_SIZE + i] = payload[i];
+		}
+		else
+		{
+			message[LINK_HEADER_SIZE + i] = payload[i];
+			payload[i] ^= block[LINK_MAC_KEY_SIZE + i];
+		}
+	}
+	/* the first 8 keystream bytes are the MAC key of this frame only */
+	SipHash_compute(block, message, LINK_HEADER_SIZE + length, tag);
+}
+
+/*
+ * Description :
+ * Keep the boot counter of a new HMI boot and wait until it is in the EEPROM (5 bytes,
+ * about 43ms once per HMI boot), so a power cut cannot open its frames to a replay.
+ */
+static void Link_savePeerBoot(uint32 boot)
+{
+	uint8 record[5];
+	uint8 crc = 0;
+
+	Link_store(record, boot);
+	for(uint8 i = 0; i < 4; i++)
+	{
+		crc = _crc8_ccitt_update(crc, record[i]);
+	}
+	record[4] = crc;
+	Storage_write(STORAGE_LINK, LINK_PEER_BOOT_OFFSET, record, sizeof(record));
+	while(Storage_isBusy(STORAGE_LINK))
+	{
+	}
+}
+
+/* little endian 32-bit word */
+static uint32 Link_load(const uint8 *bytes)
+{
+	return bytes[0] | ((uint32)bytes[1] << 8) | ((uint32)bytes[2] << 16) | ((uint32)bytes[3] << 24);
+}
+
+static void Link_store(uint8 *bytes, uint32 word)
+{
+	bytes[0] = (uint8)word;
+	bytes[1] = (uint8)(word >> 8);
+	bytes[2] = (uint8)(word >> 16);
+	bytes[3] = (uint8)(word >> 24);
+}
@@ -0,0 +1,125 @@
+ /******************************************************************************
+ *
+ * Module: Link
+ *
+ * File Name: link.h
+ *
+ * Description: Header file for the encrypted and authenticated HMI <-> Control frames
+ *
+ *******************************************************************************/
+
+#ifndef LINK_H_
+#define LINK_H_
+
+#include "std_types.h"
+#include "chacha.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+#ifndef SUCCESS
+#define ERROR 0
+#define SUCCESS 1
+#endif
+
+/*
+ * Frame: [boot counter:4][message counter:4][payload xor keystream][tag:8]
+ * The 8 header bytes are the ChaCha8 nonce, they never repeat because the boot
+ * counter is kept in EEPROM and the top bit of the message counter is the
+ * direction. Keystream block 0 gives the one time MAC key (8 bytes) then the
+ * payload keystream, the tag is HalfSipHash of header + ciphertext.
+ */
+#define LINK_HEADER_SIZE             8
+#define LINK_TAG_SIZE                8
+#define LINK_MAX_PAYLOAD             16
+#define LINK_MAC_KEY_SIZE            8
+
+/*
+ * A frame is LINK_HEADER_SIZE + payload + LINK_TAG_SIZE bytes: 21 for a PIN, 32 for a
+ * full payload (1.3ms on the wire at 250k). Cycle budget of the ChaCha8 block and the
+ * HalfSipHash of a full frame, paid once by Link_send and once by Link_receive: 4ms, so
+ * the 4 frames of an open door exchange cost at most 32ms on both sides. Link_measureFrame
+ * counts it on Timer1 at every boot, Control_ECU audits an overrun as AUDIT_EVENT_OVER_BUDGET.
+ */
+#define LINK_FRAME_BUDGET_CYCLES     (F_CPU / 250UL)
+
+/*
+ * Shared key record: key then its CRC-8, then the boot counter of this side, then
+ * the newest boot counter accepted from HMI_ECU and its CRC-8. The last one makes a
+ * restart of Control_ECU reject the frames of the HMI boots it already served, so
+ * HMI_ECU starts a new boot when Control_ECU reports its reset.
+ */
+#define LINK_KEY_OFFSET              0
+#define LINK_BOOT_COUNTER_OFFSET     (CHACHA_KEY_SIZE + 1)
+#define LINK_PEER_BOOT_OFFSET        (LINK_BOOT_COUNTER_OFFSET + 4)
+
+/*
+ * Keys derived from the shared key for the other modules, they never cross the wire.
+ * A derived key is keystream block 1 of the nonce [0xFF x7][label]: the frames only
+ * use block 0, so it is never the keystream of a frame.
+ */
+#define LINK_LABEL_PIN_HASH          'P'
+
+/*
+ * Development key used while no key was provisioned in the EEPROM of both ECUs.
+ * It is the same in every build: a lock left on it can be read and driven by anyone
+ * holding the sources. Provisioning writes a random key and its CRC-8 at the link
+ * record of the EEPROM image of both ECUs (Control_ECU at STORAGE_LINK_ADDRESS,
+ * HMI_ECU at LINK_EEPROM_ADDRESS) when they are flashed. There is no rekey over the
+ * wire: a new key is provisioned the same way. A replaced HMI_ECU must get a boot
+ * counter above the last one Control_ECU accepted, or Control_ECU a cleared link record.
+ */
+#define LINK_DEFAULT_KEY             {0x4C,0x6F,0x63,0x6B,0x65,0x72,0x4C,0x69,0x6E,0x6B,0x4B,0x65,0x79,0x30,0x30,0x31}
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef enum
+{
+	LINK_HMI,LINK_CONTROL
+}Link_Role;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Load the shared key, count this boot and load the newest boot accepted from
+ * HMI_ECU, must be called after UART_init.
+ */
+void Link_init(Link_Role role);
+
+/*
+ * Description :
+ * Encrypt, authenticate and send a payload of at most LINK_MAX_PAYLOAD bytes.
+ */
+void Link_send(const uint8 *data,uint8 length);
+
+/*
+ * Description :
+ * Receive a frame with a payload of length bytes within timeout_ms. Return SUCCESS and
+ * the decrypted payload if its tag is right and it is newer than the last frame of the
+ * other side, else ERROR and data cleared. The rest of a frame cut by the deadline is
+ * dropped so the next byte read starts a new exchange. The first frame of a new HMI
+ * boot is returned once its boot counter is saved.
+ */
+uint8 Link_receive(uint8 *data,uint8 length,uint16 timeout_ms);
+
+/*
+ * Description :
+ * Derive length bytes (at most CHACHA_BLOCK_SIZE) of a key from the shared key and a label,
+ * both ECUs get the same bytes. Must be called after Link_init.
+ */
+void Link_deriveKey(uint8 label,uint8 *key,uint8 length);
+
+/*
+ * Description :
+ * Count on Timer1 the cycles of the cipher and the MAC of a LINK_MAX_PAYLOAD frame, what
+ * Link_send and Link_receive each spend besides the UART. Nothing is sent and the counters
+ * do not move. Timer1 must be free.
+ */
+uint32 Link_measureFrame(void);
+
+#endif /* LINK_H_ */
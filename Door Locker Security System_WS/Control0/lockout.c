@@ -0,0 +1,126 @@
+ /******************************************************************************
+ *
+ * Module: Lockout
+ *
+ * File Name: lockout.c
+ *
+ * Description: Source file for the wrong PIN lockout with exponential backoff
+ *
+ *******************************************************************************/
+
+#include "lockout.h"
+#include "storage.h"
+#include "tick.h"
+#include <util/crc16.h>
+
+static Lockout_RecordType g_state = {0, 0, FALSE, 0};
+/* End of the running window on the tick time base */
+static uint32 g_lockedUntilSecond = 0;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static uint16 Lockout_window(void);
+static void Lockout_save(void);
+static uint8 Lockout_crc(const Lockout_RecordType *record_Ptr);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void Lockout_init(void)
+{
+	Lockout_RecordType record;
+
+	if((Storage_read(STORAGE_LOCKOUT, 0, (uint8 *)&record, sizeof(record)) == SUCCESS) &&
+			(record.crc == Lockout_crc(&record)) && (record.level <= LOCKOUT_MAX_LEVEL))
+	{
+		g_state = record;
+	}
+	if(g_state.isLocked)
+	{
+		g_lockedUntilSecond = Tick_getSeconds() + Lockout_window();
+	}
+}
+
+uint16 Lockout_getRetryAfter(void)
+{
+	uint32 now;
+
+	if(!g_state.isLocked)
+	{
+		return 0;
+	}
+	now = Tick_getSeconds();
+	if(now < g_lockedUntilSecond)
+	{
+		return (uint16)(g_lockedUntilSecond - now);
+	}
+
+	/* the window is over: PIN checks are allowed again, the level stays */
+	g_state.isLocked = FALSE;
+	Lockout_save();
+	return 0;
+}
+
+uint16 Lockout_recordFailure(void)
+{
+	g_state.attempts++;
+	if(g_state.attempts < LOCKOUT_TRIES)
+	{
+		Lockout_save();
+		return 0;
+	}
+
+	g_state.attempts = 0;
+	if(g_state.level < LOCKOUT_MAX_LEVEL)
+	{
+		g_state.level++;
+	}
+	g_state.isLocked = TRUE;
+	g_lockedUntilSecond = Tick_getSeconds() + Lockout_window();
+	Lockout_save();
+	return Lockout_window();
+}
+
+void Lockout_recordSuccess(void)
+{
+	if((g_state.attempts != 0) || (g_state.level != 0))
+	{
+		g_state.attempts = 0;
+		g_state.level = 0;
+		Lockout_save();
+	}
+}
+
+/*
+ * Description :
+ * Length of the window of the current level: LOCKOUT_BASE_SECONDS doubled per level.
+ */
+static uint16 Lockout_window(void)
+{
+	return (g_state.level == 0) ? 0 : (uint16)(LOCKOUT_BASE_SECONDS << (g_state.level - 1));
+}
+
+static void Lockout_save(void)
+{
+	g_state.crc = Lockout_crc(&g_state);
+	Storage_write(STORAGE_LOCKOUT, 0, (const uint8 *)&g_state, sizeof(g_state));
+}
+
+/*
+ * Description :
+ * CRC-8 (polynomial 0x07) of the record without its crc byte.
+ */
+static uint8 Lockout_crc(const Lockout_RecordType *record_Ptr)
+{
+	const uint8 *bytes = (const uint8 *)record_Ptr;
+	uint8 crc = 0;
+
+	for(uint8 i = 0; i < (sizeof(Lockout_RecordType) - 1); i++)
+	{
+		crc = _crc8_ccitt_update(crc, bytes[i]);
+	}
+	return crc;
+}
@@ -0,0 +1,71 @@
+ /******************************************************************************
+ *
+ * Module: Lockout
+ *
+ * File Name: lockout.h
+ *
+ * Description: Header file for the wrong PIN lockout with exponential backoff
+ *
+ *******************************************************************************/
+
+#ifndef LOCKOUT_H_
+#define LOCKOUT_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/*
+ * LOCKOUT_TRIES wrong PINs in a row lock every PIN check for a window that
+ * doubles at each new lockout: 60 s, 2 min, 4 min ... up to 64 min, until a
+ * right PIN is entered. The state is kept in the STORAGE_LOCKOUT record and a
+ * reset during a window starts the whole window again (a reset never shortens it).
+ */
+#define LOCKOUT_TRIES                3
+#define LOCKOUT_BASE_SECONDS         60
+#define LOCKOUT_MAX_LEVEL            7
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef struct{
+	uint8 attempts;  /* wrong PINs since the last right one or the last lockout */
+	uint8 level;     /* number of lockouts since the last right PIN */
+	uint8 isLocked;  /* TRUE while a window is running */
+	uint8 crc;       /* CRC-8 of the previous bytes */
+}Lockout_RecordType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Load the saved state and start again a window cut by a reset. Must be called after Tick_init.
+ */
+void Lockout_init(void);
+
+/*
+ * Description :
+ * Return the seconds left in the lockout window, 0 if PIN checks are allowed.
+ */
+uint16 Lockout_getRetryAfter(void);
+
+/*
+ * Description :
+ * Count a wrong PIN. Return the length of the window it started, or 0.
+ * The record is written in the background, it is saved once Storage_isBusy(STORAGE_LOCKOUT)
+ * returns FALSE: answer the wrong PIN only then.
+ */
+uint16 Lockout_recordFailure(void);
+
+/*
+ * Description :
+ * A right PIN clears the attempts and the backoff level.
+ */
+void Lockout_recordSuccess(void);
+
+#endif /* LOCKOUT_H_ */
@@ -0,0 +1,162 @@
+ /******************************************************************************
+ *
+ * Module: PIN Hash
+ *
+ * File Name: pin_hash.c
+ *
+ * Description: Source file for the salted PIN hashing and constant time compare
+ *
+ *******************************************************************************/
+
+#include "avr/io.h"
+#include "pin_hash.h"
+#include "link.h"
+#include "storage.h"
+#include "adc.h"
+#include "tick.h"
+#include "cycles.h"
+
+static uint8 g_key[SIPHASH_KEY_SIZE];
+/* Entropy pool, seeded at boot and stirred with the timers each time random bytes are needed */
+static uint8 g_pool[SIPHASH_OUTPUT_SIZE];
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void PinHash_stir(void);
+static void PinHash_mix(const uint8 *sample);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void PinHash_init(void)
+{
+	ADC_ConfigType adc_config = {ADC_AVCC, ADC_PRESCALE_8, PIN_HASH_NOISE_ADC_CHANNEL};
+	uint8 sample[8];
+	uint8 kept[SIPHASH_OUTPUT_SIZE];
+	uint16 conversion;
+
+	Link_deriveKey(LINK_LABEL_PIN_HASH, g_key, SIPHASH_KEY_SIZE);
+
+	/* go on from the pool of the last boot, keyed by this lock */
+	Storage_read(STORAGE_CONFIG, PIN_HASH_POOL_OFFSET, g_pool, SIPHASH_OUTPUT_SIZE);
+	SipHash_compute(g_key, g_pool, SIPHASH_OUTPUT_SIZE, g_pool);
+
+#if !ADC_TEST_INPUT
+	/* an ADC clock of 1MHz, 5 times the rated one, leaves noise in the low bits of each conversion */
+	ADC_init(&adc_config);
+	ADC_start();
+	for(uint8 i = 0; i < PIN_HASH_NOISE_SAMPLES; i++)
+	{
+		while(ADC_getSample(&conversion) == ERROR)
+		{
+		}
+		sample[(i % 4) * 2] = (uint8)conversion;
+		sample[(i % 4) * 2 + 1] = TCNT0 ^ TCNT2;
+		if((i % 4) == 3)
+		{
+			PinHash_mix(sample);
+		}
+	}
+	ADC_stop();
+	/* the motor driver starts from an empty ring */
+	while(ADC_getSample(&conversion) == SUCCESS)
+	{
+	}
+#endif
+	PinHash_stir();
+
+	/* the next boot starts from a one way step of the pool, not from the pool in use */
+	SipHash_compute(g_pool, g_key, SIPHASH_KEY_SIZE, kept);
+	Storage_write(STORAGE_CONFIG, PIN_HASH_POOL_OFFSET, kept, SIPHASH_OUTPUT_SIZE);
+}
+
+void PinHash_newSalt(uint8 *salt)
+{
+	PinHash_stir();
+	for(uint8 i = 0; i < PIN_HASH_SALT_SIZE; i++)
+	{
+		salt[i] = g_pool[i];
+	}
+}
+
+void PinHash_compute(const uint8 *salt, const uint8 *pin, uint8 length, uint8 *hash)
+{
+	uint8 message[PIN_HASH_SALT_SIZE + PIN_HASH_MAX_PIN_SIZE];
+
+	if(length > PIN_HASH_MAX_PIN_SIZE)
+	{
+		length = PIN_HASH_MAX_PIN_SIZE;
+	}
+	for(uint8 i = 0; i < PIN_HASH_SALT_SIZE; i++)
+	{
+		message[i] = salt[i];
+	}
+	for(uint8 i = 0; i < length; i++)
+	{
+		message[PIN_HASH_SALT_SIZE + i] = pin[i];
+	}
+	SipHash_compute(g_key, message, PIN_HASH_SALT_SIZE + length, hash);
+}
+
+boolean PinHash_isEqual(const uint8 *a, const uint8 *b, uint8 length)
+{
+	uint8 difference = 0;
+
+	/* no early exit: every byte is compared */
+	for(uint8 i = 0; i < length; i++)
+	{
+		difference |= a[i] ^ b[i];
+	}
+	return (difference == 0);
+}
+
+uint32 PinHash_measure(void)
+{
+	uint8 salt[PIN_HASH_SALT_SIZE] = {0};
+	uint8 pin[PIN_HASH_MEASURE_DIGITS] = {0};
+	uint8 stored[PIN_HASH_SIZE] = {0};
+	uint8 hash[PIN_HASH_SIZE];
+	boolean isEqual;
+	uint32 cycles;
+
+	/* the same calls as a check of a received password */
+	Cycles_start();
+	PinHash_compute(salt, pin, PIN_HASH_MEASURE_DIGITS, hash);
+	isEqual = PinHash_isEqual(hash, stored, PIN_HASH_SIZE);
+	cycles = Cycles_stop();
+	(void)isEqual;
+	return cycles;
+}
+
+/*
+ * Description :
+ * Mix the free running timers and the tick into the entropy pool. Only the time of
+ * the requests is unknown, so the pool is stirred at each salt and kept between them.
+ */
+static void PinHash_stir(void)
+{
+	uint32 ms = Tick_getMs();
+	uint8 sample[8];
+
+	sample[0] = (uint8)ms;
+	sample[1] = (uint8)(ms >> 8);
+	sample[2] = (uint8)(ms >> 16);
+	sample[3] = (uint8)(ms >> 24);
+	sample[4] = TCNT0;
+	sample[5] = TCNT1L;
+	sample[6] = TCNT1H;
+	sample[7] = TCNT2;
+	PinHash_mix(sample);
+}
+
+/*
+ * Description :
+ * Hash 8 bytes of samples into the pool.
+ */
+static void PinHash_mix(const uint8 *sample)
+{
+	SipHash_compute(g_pool, sample, 8, g_pool);
+}
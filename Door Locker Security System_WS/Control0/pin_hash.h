@@ -0,0 +1,90 @@
+ /******************************************************************************
+ *
+ * Module: PIN Hash
+ *
+ * File Name: pin_hash.h
+ *
+ * Description: Header file for the salted PIN hashing and constant time compare
+ *
+ *******************************************************************************/
+
+#ifndef PIN_HASH_H_
+#define PIN_HASH_H_
+
+#include "std_types.h"
+#include "siphash.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/*
+ * A stored credential is salt + HalfSipHash(device key, salt + PIN): an EEPROM dump
+ * gives neither the PINs nor a table usable on another lock. The device key is
+ * derived from the provisioned link key (LINK_LABEL_PIN_HASH), so HMI_ECU computes
+ * the same hashes without the key ever crossing the wire. A lock left on the
+ * development link key has a public device key, its hashes are only salted.
+ */
+#define PIN_HASH_SALT_SIZE           4
+#define PIN_HASH_SIZE                SIPHASH_OUTPUT_SIZE
+#define PIN_HASH_RECORD_SIZE         (PIN_HASH_SALT_SIZE + PIN_HASH_SIZE)
+#define PIN_HASH_MAX_PIN_SIZE        8
+
+/*
+ * Entropy pool of the salts and nonces, kept in the STORAGE_CONFIG record so the
+ * next boot goes on from it: each boot mixes in the device key and the low bits of
+ * PIN_HASH_NOISE_SAMPLES conversions of PIN_HASH_NOISE_ADC_CHANNEL at an ADC clock
+ * far above its rated one, with the timer bytes at each of them.
+ */
+#define PIN_HASH_POOL_OFFSET         0
+#define PIN_HASH_NOISE_SAMPLES       64
+/* the motor current sense input, the motor is off at boot */
+#define PIN_HASH_NOISE_ADC_CHANNEL   1
+
+/*
+ * Cycle budget of one PIN check, PinHash_compute of a 5 digit PIN plus PinHash_isEqual
+ * of the hashes: 2ms. A password check hashes up to 3 times (system password, lookup
+ * tag, salted user hash) and stays under 6ms. PinHash_measure counts it on Timer1 at
+ * every boot, Control_ECU audits an overrun as AUDIT_EVENT_OVER_BUDGET.
+ */
+#define PIN_HASH_BUDGET_CYCLES       (F_CPU / 500UL)
+#define PIN_HASH_MEASURE_DIGITS      5
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Derive the device key from the link key and seed the entropy pool from the kept one
+ * and the ADC noise. Must be called after Link_init and Tick_init and before the motor
+ * driver takes the ADC.
+ */
+void PinHash_init(void);
+
+/*
+ * Description :
+ * Make a new salt (or nonce) from the timers mixed into the entropy pool.
+ */
+void PinHash_newSalt(uint8 *salt);
+
+/*
+ * Description :
+ * Hash a PIN (at most PIN_HASH_MAX_PIN_SIZE digits) with a salt into PIN_HASH_SIZE bytes.
+ */
+void PinHash_compute(const uint8 *salt,const uint8 *pin,uint8 length,uint8 *hash);
+
+/*
+ * Description :
+ * Compare two arrays in a time that does not depend on where they differ.
+ */
+boolean PinHash_isEqual(const uint8 *a,const uint8 *b,uint8 length);
+
+/*
+ * Description :
+ * Count the cycles of PinHash_compute of a PIN_HASH_MEASURE_DIGITS PIN plus PinHash_isEqual
+ * of the hashes on Timer1, to be checked against PIN_HASH_BUDGET_CYCLES. Timer1 must be free.
+ */
+uint32 PinHash_measure(void);
+
+#endif /* PIN_HASH_H_ */
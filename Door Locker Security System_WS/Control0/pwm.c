@@ -14,35 +14,40 @@
  *******************************************************************************/
 
 /*
-• Description:
-➢ The function responsible for trigger the Timer0 with the PWM Mode.
-➢ Setup the PWM mode with Non-Inverting.
-➢ Setup the prescaler with F_CPU/8.
-➢ Setup the compare value based on the required input duty cycle
+ • Description:
+➢ The function responsible for setup the Timer0 with the required PWM Mode once.
+➢ Setup the PWM output with Non-Inverting.
+➢ Setup the prescaler which selects the PWM frequency.
+➢ Start with duty cycle 0.
 ➢ Setup the direction for OC0 as output pin through the GPIO driver.
-➢ The generated PWM signal frequency will be 500Hz to control the DC
-Motor speed
  */
-void PWM_Timer0_Start(uint8 duty_cycle)
+void PWM_init(const PWM_ConfigType * Config_Ptr)
 {
-	/* configure the timer*/
 	/* Set Timer Initial Value to 0*/
 	TCNT0 = 0;
-	/*Fast PWM mode FOC0=0 (Active only when the WGM00 bit specifies a non-PWM mode)*/
-	CLEAR_BIT(TCCR0,FOC0);
-	/*Fast PWM Mode WGM01=1 & WGM00=1*/
-	SET_BIT(TCCR0,WGM00);
-	SET_BIT(TCCR0,WGM01);
-	/*Clear OC0 when match occurs (non inverted mode) COM00=0 & COM01=1*/
-	SET_BIT(TCCR0,COM01);
-	CLEAR_BIT(TCCR0,COM00);
-	/*Clock = F_CPU/8 CS00=0 CS01=1 CS02=0*/
-	CLEAR_BIT(TCCR0,CS00);
-	SET_BIT(TCCR0,CS01);
-	CLEAR_BIT(TCCR0,CS02);
-	/*Set Compare value*/
-	OCR0  =(uint8)((uint16)(duty_cycle*255) /100);
+	OCR0 = 0;
+	/*PWM mode FOC0=0 (Active only when the WGM00 bit specifies a non-PWM mode)
+	  WGM00=1 for both modes, WGM01=1 for fast PWM only
+	  Clear OC0 when match occurs (non inverted mode) COM00=0 & COM01=1*/
+	TCCR0 = (1<<WGM00) | (1<<COM01);
+	if(Config_Ptr->mode == PWM_FAST_MODE)
+	{
+		SET_BIT(TCCR0,WGM01);
+	}
+	/*Select the prescaler, the timer starts counting*/
+	TCCR0 = (TCCR0 & 0xF8) | (Config_Ptr->prescaler);
 	/*Set PB3/OC0 as output pin --> pin where the PWM signal is generated from MC.*/
 	GPIO_setupPinDirection(PORTB_ID,PIN3_ID,PIN_OUTPUT);
+}
 
+/*
+ • Description:
+➢ Set the duty cycle in percent, only OCR0 is written.
+➢ The hardware applies the new value at the end of the running period so the
+  output never glitches, it is safe to call from an ISR.
+ */
+void PWM_setDuty(uint8 duty_cycle)
+{
+	/* OCR0 is double buffered in the PWM modes, a single byte write needs no locking */
+	OCR0 = (uint8)(((uint16)duty_cycle * 255) / 100);
 }
@@ -9,21 +9,50 @@
 
 #include "std_types.h"
 
+/*******************************************************************************
+ *                       definitions                                    *
+ *******************************************************************************/
+
+typedef enum
+{
+	PWM_NO_CLOCK,PWM_NO_PRESCALING,PWM_PRESCALE_8,PWM_PRESCALE_64,PWM_PRESCALE_256,PWM_PRESCALE_1024
+}PWM_Prescaler;
+
+/*
+ * The PWM frequency is F_CPU/(prescaler*256) in fast mode and F_CPU/(prescaler*510)
+ * in phase correct mode, at 8MHz without prescaling: 31.25KHz and 15.7KHz.
+ */
+typedef enum
+{
+	PWM_PHASE_CORRECT_MODE,PWM_FAST_MODE
+}PWM_Mode;
+
+typedef struct {
+ PWM_Mode mode;
+ PWM_Prescaler prescaler;
+} PWM_ConfigType;
+
 /*******************************************************************************
  *                              Functions Prototypes                           *
  *******************************************************************************/
 
 /*
  • Description:
-➢ The function responsible for trigger the Timer0 with the PWM Mode.
-➢ Setup the PWM mode with Non-Inverting.
-➢ Setup the prescaler with F_CPU/8.
-➢ Setup the compare value based on the required input duty cycle
+➢ The function responsible for setup the Timer0 with the required PWM Mode once.
+➢ Setup the PWM output with Non-Inverting.
+➢ Setup the prescaler which selects the PWM frequency.
+➢ Start with duty cycle 0.
 ➢ Setup the direction for OC0 as output pin through the GPIO driver.
-➢ The generated PWM signal frequency will be 500Hz to control the DC
-Motor speed
  */
-void PWM_Timer0_Start(uint8 duty_cycle);
+void PWM_init(const PWM_ConfigType * Config_Ptr);
+
+/*
+ • Description:
+➢ Set the duty cycle in percent, only OCR0 is written.
+➢ The hardware applies the new value at the end of the running period so the
+  output never glitches, it is safe to call from an ISR.
+ */
+void PWM_setDuty(uint8 duty_cycle);
 
 
 #endif /* PWM_H_ */
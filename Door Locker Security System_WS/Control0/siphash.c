@@ -0,0 +1,116 @@
+ /******************************************************************************
+ *
+ * Module: SipHash
+ *
+ * File Name: siphash.c
+ *
+ * Description: Source file for the HalfSipHash-2-4 keyed hash (32-bit words for AVR)
+ *
+ *******************************************************************************/
+
+#include "siphash.h"
+
+/*
+ * HalfSipHash works on 32-bit words: four 4-register words stay in the AVR
+ * register file where SipHash needs 64-bit words. The AVR has no barrel shifter,
+ * so every rotation is a whole byte move (free) plus at most 3 single-bit shifts:
+ * 5 = 8 - 3, 7 = 8 - 1 and 13 = 16 - 3.
+ */
+#define ROTL16(x)     (((x) << 16) | ((x) >> 16))
+#define ROTL8(x)      (((x) << 8) | ((x) >> 24))
+#define ROTR(x,b)     (((x) >> (b)) | ((x) << (32 - (b))))
+
+#define SIPHASH_C_ROUNDS             2
+#define SIPHASH_D_ROUNDS             4
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void SipHash_rounds(uint32 *v,uint8 rounds);
+static uint32 SipHash_load(const uint8 *bytes);
+static void SipHash_store(uint8 *bytes,uint32 word);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void SipHash_compute(const uint8 *key, const uint8 *data, uint8 length, uint8 *output)
+{
+	uint32 v[4];
+	uint32 k0 = SipHash_load(key);
+	uint32 k1 = SipHash_load(key + 4);
+	uint32 m;
+	uint8 i;
+
+	v[0] = k0;
+	v[1] = k1 ^ 0xEE;
+	v[2] = k0 ^ 0x6C796765UL;
+	v[3] = k1 ^ 0x74656462UL;
+
+	/* whole 4 bytes words */
+	for(i = 0; (uint8)(i + 4) <= length; i += 4)
+	{
+		m = SipHash_load(data + i);
+		v[3] ^= m;
+		SipHash_rounds(v, SIPHASH_C_ROUNDS);
+		v[0] ^= m;
+	}
+
+	/* last word: the remaining bytes and the length in the top byte */
+	m = (uint32)length << 24;
+	for(uint8 j = 0; i < length; i++, j += 8)
+	{
+		m |= (uint32)data[i] << j;
+	}
+	v[3] ^= m;
+	SipHash_rounds(v, SIPHASH_C_ROUNDS);
+	v[0] ^= m;
+
+	/* finalization of the 64-bit output */
+	v[2] ^= 0xEE;
+	SipHash_rounds(v, SIPHASH_D_ROUNDS);
+	SipHash_store(output, v[1] ^ v[3]);
+	v[1] ^= 0xDD;
+	SipHash_rounds(v, SIPHASH_D_ROUNDS);
+	SipHash_store(output + 4, v[1] ^ v[3]);
+}
+
+/*
+ * Description :
+ * SipRound of HalfSipHash repeated rounds times.
+ */
+static void SipHash_rounds(uint32 *v, uint8 rounds)
+{
+	uint32 v0 = v[0];
+	uint32 v1 = v[1];
+	uint32 v2 = v[2];
+	uint32 v3 = v[3];
+
+	while(rounds--)
+	{
+		v0 += v1; v1 = ROTL8(v1); v1 = ROTR(v1, 3); v1 ^= v0; v0 = ROTL16(v0);
+		v2 += v3; v3 = ROTL8(v3); v3 ^= v2;
+		v0 += v3; v3 = ROTL8(v3); v3 = ROTR(v3, 1); v3 ^= v0;
+		v2 += v1; v1 = ROTL16(v1); v1 = ROTR(v1, 3); v1 ^= v2; v2 = ROTL16(v2);
+	}
+
+	v[0] = v0;
+	v[1] = v1;
+	v[2] = v2;
+	v[3] = v3;
+}
+
+/* little endian 32-bit word */
+static uint32 SipHash_load(const uint8 *bytes)
+{
+	return bytes[0] | ((uint32)bytes[1] << 8) | ((uint32)bytes[2] << 16) | ((uint32)bytes[3] << 24);
+}
+
+static void SipHash_store(uint8 *bytes, uint32 word)
+{
+	bytes[0] = (uint8)word;
+	bytes[1] = (uint8)(word >> 8);
+	bytes[2] = (uint8)(word >> 16);
+	bytes[3] = (uint8)(word >> 24);
+}
@@ -0,0 +1,34 @@
+ /******************************************************************************
+ *
+ * Module: SipHash
+ *
+ * File Name: siphash.h
+ *
+ * Description: Header file for the HalfSipHash-2-4 keyed hash (32-bit words for AVR)
+ *
+ *******************************************************************************/
+
+#ifndef SIPHASH_H_
+#define SIPHASH_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define SIPHASH_KEY_SIZE             8
+#define SIPHASH_OUTPUT_SIZE          8
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * HalfSipHash-2-4 of data with a 64-bit key and a 64-bit output.
+ * The code runs the same instructions for any key and data of a given length.
+ */
+void SipHash_compute(const uint8 *key,const uint8 *data,uint8 length,uint8 *output);
+
+#endif /* SIPHASH_H_ */
@@ -0,0 +1,100 @@
+ /******************************************************************************
+ *
+ * Module: Storage
+ *
+ * File Name: storage.c
+ *
+ * Description: Source file for the two tier storage (internal and external EEPROM)
+ *
+ *******************************************************************************/
+
+#include "storage.h"
+#include "internal_eeprom.h"
+#include "external_eeprom.h"
+
+/* Tier and place of every record, in the order of Storage_Key */
+static const Storage_RegionType g_regions[] =
+{
+	{STORAGE_INTERNAL, STORAGE_CREDENTIAL_ADDRESS, STORAGE_CREDENTIAL_SIZE},
+	{STORAGE_INTERNAL, STORAGE_CONFIG_ADDRESS, STORAGE_CONFIG_SIZE},
+	{STORAGE_INTERNAL, STORAGE_COUNTERS_ADDRESS, STORAGE_COUNTERS_SIZE},
+	{STORAGE_INTERNAL, STORAGE_LINK_ADDRESS, STORAGE_LINK_SIZE},
+	{STORAGE_INTERNAL, STORAGE_LOCKOUT_ADDRESS, STORAGE_LOCKOUT_SIZE},
+	{STORAGE_INTERNAL, STORAGE_WATCHDOG_ADDRESS, STORAGE_WATCHDOG_SIZE},
+	{STORAGE_EXTERNAL, STORAGE_CREDENTIAL_LOG_ADDRESS, STORAGE_CREDENTIAL_LOG_SIZE},
+	{STORAGE_EXTERNAL, STORAGE_USER_TABLE_ADDRESS, STORAGE_USER_TABLE_SIZE},
+	{STORAGE_EXTERNAL, STORAGE_AUDIT_LOG_ADDRESS, STORAGE_AUDIT_LOG_SIZE}
+};
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static const Storage_RegionType * Storage_region(Storage_Key key,uint16 offset,uint16 length);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+uint8 Storage_read(Storage_Key key, uint16 offset, uint8 *data, uint16 length)
+{
+	const Storage_RegionType *region_Ptr = Storage_region(key, offset, length);
+
+	if(region_Ptr == NULL_PTR)
+	{
+		return ERROR;
+	}
+	if(region_Ptr->tier == STORAGE_INTERNAL)
+	{
+		return InternalEEPROM_readBlock(region_Ptr->address + offset, data, length);
+	}
+	return EEPROM_readBlock(region_Ptr->address + offset, data, length);
+}
+
+uint8 Storage_write(Storage_Key key, uint16 offset, const uint8 *data, uint16 length)
+{
+	const Storage_RegionType *region_Ptr = Storage_region(key, offset, length);
+
+	if(region_Ptr == NULL_PTR)
+	{
+		return ERROR;
+	}
+	if(region_Ptr->tier == STORAGE_INTERNAL)
+	{
+		return InternalEEPROM_writeBlock(region_Ptr->address + offset, data, length);
+	}
+	return EEPROM_writeBlock(region_Ptr->address + offset, data, length);
+}
+
+uint8 Storage_writeAsync(Storage_Key key, uint16 offset, const uint8 *data, uint8 length, void(*a_ptr)(TWI_TransferStatus))
+{
+	const Storage_RegionType *region_Ptr = Storage_region(key, offset, length);
+
+	if((region_Ptr == NULL_PTR) || (region_Ptr->tier != STORAGE_EXTERNAL))
+	{
+		return ERROR;
+	}
+	return EEPROM_writeBlockAsync(region_Ptr->address + offset, data, length, a_ptr);
+}
+
+boolean Storage_isBusy(Storage_Key key)
+{
+	if(g_regions[key].tier == STORAGE_INTERNAL)
+	{
+		return InternalEEPROM_isBusy();
+	}
+	return EEPROM_isBusy();
+}
+
+/*
+ * Description :
+ * Return the region of key, or NULL_PTR if the access goes out of it.
+ */
+static const Storage_RegionType * Storage_region(Storage_Key key, uint16 offset, uint16 length)
+{
+	if((key > STORAGE_AUDIT_LOG) || (((uint32)offset + length) > g_regions[key].size))
+	{
+		return NULL_PTR;
+	}
+	return &g_regions[key];
+}
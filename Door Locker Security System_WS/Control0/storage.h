@@ -0,0 +1,101 @@
+ /******************************************************************************
+ *
+ * Module: Storage
+ *
+ * File Name: storage.h
+ *
+ * Description: Header file for the two tier storage (internal and external EEPROM)
+ *
+ *******************************************************************************/
+
+#ifndef STORAGE_H_
+#define STORAGE_H_
+
+#include "std_types.h"
+#include "twi.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+#ifndef SUCCESS
+#define ERROR 0
+#define SUCCESS 1
+#endif
+
+/*
+ * Hot tier: small records read on every check or rewritten often, kept in the
+ * internal EEPROM (no bus transfer, written in the background by EE_READY).
+ */
+#define STORAGE_CREDENTIAL_ADDRESS       0x000
+#define STORAGE_CREDENTIAL_SIZE          64
+#define STORAGE_CONFIG_ADDRESS           0x040
+#define STORAGE_CONFIG_SIZE              32
+#define STORAGE_COUNTERS_ADDRESS         0x060
+#define STORAGE_COUNTERS_SIZE            256
+#define STORAGE_LINK_ADDRESS             0x160
+#define STORAGE_LINK_SIZE                32
+#define STORAGE_LOCKOUT_ADDRESS          0x180
+#define STORAGE_LOCKOUT_SIZE             16
+#define STORAGE_WATCHDOG_ADDRESS         0x190
+#define STORAGE_WATCHDOG_SIZE            32
+
+/* Cold tier: bulk data in the external 24C16 */
+#define STORAGE_CREDENTIAL_LOG_ADDRESS   0x000
+#define STORAGE_CREDENTIAL_LOG_SIZE      512
+#define STORAGE_USER_TABLE_ADDRESS       0x200
+#define STORAGE_USER_TABLE_SIZE          768
+#define STORAGE_AUDIT_LOG_ADDRESS        0x500
+#define STORAGE_AUDIT_LOG_SIZE           768
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef enum
+{
+	STORAGE_CREDENTIAL,STORAGE_CONFIG,STORAGE_COUNTERS,STORAGE_LINK,STORAGE_LOCKOUT,STORAGE_WATCHDOG,
+	STORAGE_CREDENTIAL_LOG,STORAGE_USER_TABLE,STORAGE_AUDIT_LOG
+}Storage_Key;
+
+typedef enum
+{
+	STORAGE_INTERNAL,STORAGE_EXTERNAL
+}Storage_Tier;
+
+typedef struct{
+	Storage_Tier tier;
+	uint16 address;
+	uint16 size;
+}Storage_RegionType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Read length bytes at offset of the record of key, from the tier holding it.
+ */
+uint8 Storage_read(Storage_Key key,uint16 offset,uint8 *data,uint16 length);
+
+/*
+ * Description :
+ * Write length bytes at offset of the record of key.
+ * Hot records return once queued, cold records once sent to the external memory.
+ */
+uint8 Storage_write(Storage_Key key,uint16 offset,const uint8 *data,uint16 length);
+
+/*
+ * Description :
+ * Start a write of one external page in the background, the call back is called
+ * from the TWI interrupt. Only the cold records can be written this way.
+ */
+uint8 Storage_writeAsync(Storage_Key key,uint16 offset,const uint8 *data,uint8 length,void(*a_ptr)(TWI_TransferStatus));
+
+/*
+ * Description :
+ * Return TRUE while the memory holding the record of key is still writing.
+ */
+boolean Storage_isBusy(Storage_Key key);
+
+#endif /* STORAGE_H_ */
@@ -0,0 +1,69 @@
+/*
+ * tick.c
+ *
+ *      Author: Ayman_Mostafa
+ */
+
+#include "avr/io.h"
+#include "tick.h"
+#include "timer2.h"
+#include <avr/interrupt.h>
+
+static volatile uint32 g_ms = 0;
+static void (* volatile g_callBackPtr[TICK_CALLBACKS_NUMBER])(void);
+static volatile uint8 g_callBacksNumber = 0;
+
+/* this function is executed each 1 millisecond*/
+static void Tick_count(void)
+{
+	g_ms++;
+	for(uint8 i = 0; i < g_callBacksNumber; i++)
+	{
+		(*g_callBackPtr[i])();
+	}
+}
+
+/* Description
+⮚ Start the 1ms system tick on Timer2 in compare mode.*/
+void Tick_init(void)
+{
+	Timer2_ConfigType config = {0,TICK_COMPARE_VALUE,TIMER2_PRESCALE_64,TIMER2_COMPARE_MODE};
+	Timer2_setCallBack(Tick_count);
+	Timer2_init(&config);
+}
+
+/* Description
+⮚ Return the number of milliseconds since Tick_init.*/
+uint32 Tick_getMs(void)
+{
+	uint32 ms;
+	uint8 sreg = SREG;
+
+	/* the 32-bit counter is read with the tick interrupt masked */
+	cli();
+	ms = g_ms;
+	SREG = sreg;
+	return ms;
+}
+
+/* Description
+⮚ Return the number of seconds since Tick_init.*/
+uint32 Tick_getSeconds(void)
+{
+	return Tick_getMs() / 1000;
+}
+
+/* Description
+⮚ Add a function to be called from the tick interrupt each 1ms.*/
+void Tick_addCallBack(void(*a_ptr)(void))
+{
+	uint8 sreg = SREG;
+
+	cli();
+	if(g_callBacksNumber < TICK_CALLBACKS_NUMBER)
+	{
+		g_callBackPtr[g_callBacksNumber] = a_ptr;
+		g_callBacksNumber++;
+	}
+	SREG = sreg;
+}
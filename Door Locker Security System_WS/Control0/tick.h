@@ -0,0 +1,40 @@
+/*
+ * tick.h
+ *
+ *      Author: Ayman_Mostafa
+ */
+
+#ifndef TICK_H_
+#define TICK_H_
+
+#include "std_types.h"
+
+/* Timer2 compare value giving one interrupt each 1ms with F_CPU/64 */
+#define TICK_COMPARE_VALUE          ((F_CPU / 64UL / 1000UL) - 1)
+
+/* Functions that can be called from the tick interrupt: the buzzer and the motor ramps */
+#define TICK_CALLBACKS_NUMBER       4
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/* Description
+⮚ Start the 1ms system tick on Timer2 in compare mode.*/
+void Tick_init(void);
+
+/* Description
+⮚ Return the number of milliseconds since Tick_init.*/
+uint32 Tick_getMs(void);
+
+/* Description
+⮚ Return the number of seconds since Tick_init.*/
+uint32 Tick_getSeconds(void);
+
+/* Description
+⮚ Add a function to be called from the tick interrupt each 1ms,
+  it must be short as it runs with the interrupts disabled.
+  Up to TICK_CALLBACKS_NUMBER functions, the others are ignored.*/
+void Tick_addCallBack(void(*a_ptr)(void));
+
+#endif /* TICK_H_ */
@@ -0,0 +1,93 @@
+/*
+ * timer2.c
+ *
+ *      Author: Ayman_Mostafa
+ */
+
+#include "avr/io.h"
+#include "timer2.h"
+#include "common_macros.h"
+#include <avr/interrupt.h>
+
+
+static void (* volatile g_callBackPtr)(void) = NULL_PTR;
+
+/*******************************************************************************
+ *                              ISR                                    *
+ *******************************************************************************/
+/*ISR FOR COMPORE MODE  */
+ISR(TIMER2_COMP_vect)
+{
+	if(g_callBackPtr != NULL_PTR)
+	{
+		(*g_callBackPtr)();
+	}
+}
+
+/*ISR FOR OVERFLOW MODE  */
+ISR(TIMER2_OVF_vect)
+{
+	if(g_callBackPtr != NULL_PTR)
+	{
+		(*g_callBackPtr)();
+	}
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/* Description
+⮚ Function to initialize the Timer2 driver*/
+void Timer2_init(const Timer2_ConfigType * Config_Ptr)
+{
+	/* TCCR2 SETTING
+	 * Normal port operation, OC2 disconnected COM21=0 and COM20=0
+	 * FOC2=1 for non-PWM mode*/
+	TCCR2 = (1<<FOC2);
+
+	//Select the prescaler
+	TCCR2 = (TCCR2 & 0xF8) | (Config_Ptr->prescaler);
+
+	//Select the TIMER2 MODE
+	switch(Config_Ptr->mode)
+	{
+	case TIMER2_NORMAL_MODE:
+		CLEAR_BIT(TCCR2,WGM20);
+		CLEAR_BIT(TCCR2,WGM21);
+		//put the initial value in TCNT2
+		TCNT2=Config_Ptr->initial_value;
+		//Enable Overflow Interrupt
+		SET_BIT(TIMSK,TOIE2);
+		break;
+
+	case TIMER2_COMPARE_MODE:
+		CLEAR_BIT(TCCR2,WGM20);
+		SET_BIT(TCCR2,WGM21);
+		//put the compare value in OCR2
+		TCNT2 = Config_Ptr->initial_value;
+		OCR2=Config_Ptr->compare_value;
+		//Enable Output Compare Match Interrupt
+		SET_BIT(TIMSK,OCIE2);
+		break;
+	}
+}
+
+/*Description
+⮚ Function to disable the Timer2.*/
+void Timer2_deInit(void)
+{
+	TCCR2=0;
+	OCR2=0;
+	TCNT2=0;
+	TIMSK=TIMSK&0x3F;
+	/* Reset the global pointer value */
+	g_callBackPtr = NULL_PTR;
+}
+
+/*Description
+⮚ Function to set the Call Back function address.*/
+void Timer2_setCallBack(void(*a_ptr)(void))
+{
+	g_callBackPtr=a_ptr;
+}
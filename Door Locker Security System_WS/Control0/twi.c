@@ -11,29 +11,162 @@
 
 #include "twi.h"
 #include "common_macros.h"
+#include "gpio.h"
 #include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
 
-void TWI_init(const TWI_ConfigType * Config_Ptr)
+/* Last configuration, re-applied after a bus recovery */
+static TWI_ConfigType g_twiConfig;
+/* TWBR and TWPS in use, a bus recovery restores them as they are so a probed rate is kept */
+static uint8 g_twbr = 0;
+static uint8 g_twps = 0;
+/* Error of the last blocking operation */
+static TWI_Error g_twiError = TWI_ERROR_NONE;
+
+/* Transfer currently handled by the TWI interrupt */
+static TWI_TransferType * volatile g_transfer_Ptr = NULL_PTR;
+static volatile TWI_TransferStatus g_transferStatus = TWI_TRANSFER_IDLE;
+static volatile uint8 g_writeIndex = 0;
+static volatile uint8 g_readIndex = 0;
+static volatile uint8 g_arbitrationRetries = 0;
+/* Incremented by every TWI interrupt, used to detect a transfer that stopped progressing */
+static volatile uint8 g_transferEvents = 0;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void TWI_endTransfer(TWI_TransferStatus status);
+static void TWI_reportTransfer(TWI_TransferStatus status);
+static TWI_Error TWI_waitForFlag(void);
+static TWI_Error TWI_waitForStop(void);
+static void TWI_setBitRate(uint32 bit_rate);
+static void TWI_enable(void);
+
+/*******************************************************************************
+ *                              ISR                                    *
+ *******************************************************************************/
+ISR(TWI_vect)
 {
-	/* Bit Rate: 400.000 kbps or 100.00 kbps using zero pre-scaler TWPS=00 and F_CPU=8Mhz */
-	switch(Config_Ptr->bit_rate)
+	TWI_TransferType *transfer_Ptr = g_transfer_Ptr;
+
+	g_transferEvents++;
+
+	switch(TWI_getStatus())
 	{
-	case NORMAL_MODE_100_KB_PER_SEC:
-		TWBR = 32;
+	case TWI_START:
+	case TWI_REP_START:
+		/* Address the slave for write while there is data to send (or for an ACK probe), else for read */
+		if((g_writeIndex < transfer_Ptr->write_length) || (transfer_Ptr->read_length == 0))
+		{
+			TWDR = (uint8)(transfer_Ptr->slave_address << 1);
+		}
+		else
+		{
+			TWDR = (uint8)((transfer_Ptr->slave_address << 1) | 1);
+		}
+		TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
 		break;
-	case FAST_MODE_400_KB_PER_SEC:
-		TWBR = 0x02;
+
+	case TWI_MT_SLA_W_ACK:
+	case TWI_MT_DATA_ACK:
+		if(g_writeIndex < transfer_Ptr->write_length)
+		{
+			/* Send the next byte */
+			TWDR = transfer_Ptr->write_data[g_writeIndex];
+			g_writeIndex++;
+			TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+		}
+		else if(transfer_Ptr->read_length != 0)
+		{
+			/* Send the Repeated Start Bit to switch to read */
+			TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN) | (1 << TWIE);
+		}
+		else
+		{
+			TWI_endTransfer(TWI_TRANSFER_DONE);
+		}
+		break;
+
+	case TWI_MT_SLA_R_ACK:
+		/* ACK every received byte except the last one */
+		if(transfer_Ptr->read_length > 1)
+		{
+			TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWEA) | (1 << TWIE);
+		}
+		else
+		{
+			TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+		}
+		break;
+
+	case TWI_MR_DATA_ACK:
+		transfer_Ptr->read_data[g_readIndex] = TWDR;
+		g_readIndex++;
+		if(g_readIndex < (uint8)(transfer_Ptr->read_length - 1))
+		{
+			TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWEA) | (1 << TWIE);
+		}
+		else
+		{
+			TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+		}
+		break;
+
+	case TWI_MR_DATA_NACK:
+		/* Last byte of the transfer */
+		transfer_Ptr->read_data[g_readIndex] = TWDR;
+		g_readIndex++;
+		TWI_endTransfer(TWI_TRANSFER_DONE);
+		break;
+
+	case TWI_MT_SLA_W_NACK:
+	case TWI_MT_DATA_NACK:
+	case TWI_MR_SLA_R_NACK:
+		TWI_endTransfer(TWI_TRANSFER_NACK);
+		break;
+
+	case TWI_ARB_LOST:
+		/* Another master won the bus: restart the whole transfer once the bus is free */
+		if(g_arbitrationRetries != 0)
+		{
+			g_arbitrationRetries--;
+			g_writeIndex = 0;
+			g_readIndex = 0;
+			TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN) | (1 << TWIE);
+		}
+		else
+		{
+			/* The bus is released without a STOP as it is owned by the other master */
+			TWCR = (1 << TWINT) | (1 << TWEN);
+			TWI_reportTransfer(TWI_TRANSFER_ARB_LOST);
+		}
+		break;
+
+	case TWI_BUS_ERROR:
+	default:
+		/* TWSTO=1 releases the SDA/SCL lines and recovers the TWI from a bus error, no STOP is sent */
+		TWI_endTransfer(TWI_TRANSFER_ERROR);
 		break;
 	}
-	TWSR = 0x00;
-	/* Two Wire Bus address my address if any master device want to call me: my address = Config_Ptr->address (used in case this MC is a slave device)
-       General Call Recognition: Off */
-	TWAR =  (Config_Ptr->address <<1) ; // my address = Config_Ptr->address (127:0)
+}
 
-	TWCR = (1<<TWEN); /* enable TWI */
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void TWI_init(const TWI_ConfigType * Config_Ptr)
+{
+	/* Keep the configuration for TWI_recoverBus */
+	g_twiConfig = *Config_Ptr;
+
+	/* Bit Rate: TWBR and pre-scaler TWPS computed from F_CPU for the required SCL frequency */
+	TWI_setBitRate(Config_Ptr->bit_rate);
+	TWI_enable();
 }
 
-void TWI_start(void)
+TWI_Error TWI_start(void)
 {
 	/*
 	 * Clear the TWINT flag before sending the start bit TWINT=1
@@ -43,10 +176,10 @@ void TWI_start(void)
 	TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN);
 
 	/* Wait for TWINT flag set in TWCR Register (start bit is send successfully) */
-	while(BIT_IS_CLEAR(TWCR,TWINT));
+	return TWI_waitForFlag();
 }
 
-void TWI_stop(void)
+TWI_Error TWI_stop(void)
 {
 	/*
 	 * Clear the TWINT flag before sending the stop bit TWINT=1
@@ -54,9 +187,13 @@ void TWI_stop(void)
 	 * Enable TWI Module TWEN=1 
 	 */
 	TWCR = (1 << TWINT) | (1 << TWSTO) | (1 << TWEN);
+
+	/* Wait for TWSTO flag cleared by the hardware (stop bit is send successfully) */
+	g_twiError = TWI_waitForStop();
+	return g_twiError;
 }
 
-void TWI_writeByte(uint8 data)
+TWI_Error TWI_writeByte(uint8 data)
 {
 	/* Put data On TWI data Register */
 	TWDR = data;
@@ -66,7 +203,7 @@ void TWI_writeByte(uint8 data)
 	 */ 
 	TWCR = (1 << TWINT) | (1 << TWEN);
 	/* Wait for TWINT flag set in TWCR Register(data is send successfully) */
-	while(BIT_IS_CLEAR(TWCR,TWINT));
+	return TWI_waitForFlag();
 }
 
 uint8 TWI_readByteWithACK(void)
@@ -78,7 +215,7 @@ uint8 TWI_readByteWithACK(void)
 	 */ 
 	TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWEA);
 	/* Wait for TWINT flag set in TWCR Register (data received successfully) */
-	while(BIT_IS_CLEAR(TWCR,TWINT));
+	TWI_waitForFlag();
 	/* Read Data */
 	return TWDR;
 }
@@ -91,7 +228,7 @@ uint8 TWI_readByteWithNACK(void)
 	 */
 	TWCR = (1 << TWINT) | (1 << TWEN);
 	/* Wait for TWINT flag set in TWCR Register (data received successfully) */
-	while(BIT_IS_CLEAR(TWCR,TWINT));
+	TWI_waitForFlag();
 	/* Read Data */
 	return TWDR;
 }
@@ -103,3 +240,311 @@ uint8 TWI_getStatus(void)
 	status = TWSR & 0xF8;
 	return status;
 }
+
+TWI_Error TWI_getError(void)
+{
+	return g_twiError;
+}
+
+uint32 TWI_getBitRate(void)
+{
+	/* SCL frequency = F_CPU / (16 + 2 * TWBR * 4^TWPS) */
+	return F_CPU / (16 + (2UL * TWBR << (2 * (TWSR & 0x03))));
+}
+
+uint32 TWI_probeMaxBitRate(uint8 slave_address, uint32 max_bit_rate)
+{
+	TWI_TransferType probe = {slave_address, NULL_PTR, 0, NULL_PTR, 0, NULL_PTR};
+	uint32 bit_rate;
+	uint8 attempts;
+
+	/* Start from the fastest allowed rate and slow down until the slave answers reliably */
+	TWI_setBitRate(max_bit_rate);
+	while(1)
+	{
+		bit_rate = TWI_getBitRate();
+		/* Address only transfers: START, SLA+W, STOP */
+		for(attempts = 0; attempts < TWI_PROBE_ATTEMPTS; attempts++)
+		{
+			TWI_startTransfer(&probe);
+			if(TWI_waitTransfer() != TWI_TRANSFER_DONE)
+			{
+				break;
+			}
+		}
+		if(attempts == TWI_PROBE_ATTEMPTS)
+		{
+			/* TWBR and TWPS stay as they are, TWI_recoverBus restores them without rounding */
+			return bit_rate;
+		}
+		if((TWBR == 0xFF) && ((TWSR & 0x03) == 0x03))
+		{
+			/* Slowest bus and still no answer */
+			TWI_setBitRate(g_twiConfig.bit_rate);
+			return 0;
+		}
+		/* Next lower rate */
+		TWI_setBitRate(bit_rate - 1);
+	}
+}
+
+boolean TWI_recoverBus(void)
+{
+	boolean released;
+
+	/* Disable the TWI module so SCL and SDA are controlled by the GPIO */
+	TWCR = 0;
+
+	/* Release both lines: input pins with the internal pull-up */
+	GPIO_setupPinDirection(TWI_SDA_PORT_ID,TWI_SDA_PIN_ID,PIN_INPUT);
+	GPIO_writePin(TWI_SDA_PORT_ID,TWI_SDA_PIN_ID,LOGIC_HIGH);
+	GPIO_setupPinDirection(TWI_SCL_PORT_ID,TWI_SCL_PIN_ID,PIN_INPUT);
+	GPIO_writePin(TWI_SCL_PORT_ID,TWI_SCL_PIN_ID,LOGIC_HIGH);
+	_delay_us(TWI_RECOVERY_HALF_PERIOD_US);
+
+	/* Clock SCL until the slave finishes its byte and releases SDA */
+	for(uint8 i = 0; (i < TWI_RECOVERY_CLOCKS) && (GPIO_readPin(TWI_SDA_PORT_ID,TWI_SDA_PIN_ID) == LOGIC_LOW); i++)
+	{
+		/* SCL low: open drain emulation, disable the pull-up then drive the pin */
+		GPIO_writePin(TWI_SCL_PORT_ID,TWI_SCL_PIN_ID,LOGIC_LOW);
+		GPIO_setupPinDirection(TWI_SCL_PORT_ID,TWI_SCL_PIN_ID,PIN_OUTPUT);
+		_delay_us(TWI_RECOVERY_HALF_PERIOD_US);
+		/* SCL high: released to the pull-up */
+		GPIO_setupPinDirection(TWI_SCL_PORT_ID,TWI_SCL_PIN_ID,PIN_INPUT);
+		GPIO_writePin(TWI_SCL_PORT_ID,TWI_SCL_PIN_ID,LOGIC_HIGH);
+		_delay_us(TWI_RECOVERY_HALF_PERIOD_US);
+	}
+
+	released = (GPIO_readPin(TWI_SDA_PORT_ID,TWI_SDA_PIN_ID) == LOGIC_HIGH);
+	if(released)
+	{
+		/* STOP condition: SDA goes from low to high while SCL is high */
+		GPIO_writePin(TWI_SCL_PORT_ID,TWI_SCL_PIN_ID,LOGIC_LOW);
+		GPIO_setupPinDirection(TWI_SCL_PORT_ID,TWI_SCL_PIN_ID,PIN_OUTPUT);
+		GPIO_writePin(TWI_SDA_PORT_ID,TWI_SDA_PIN_ID,LOGIC_LOW);
+		GPIO_setupPinDirection(TWI_SDA_PORT_ID,TWI_SDA_PIN_ID,PIN_OUTPUT);
+		_delay_us(TWI_RECOVERY_HALF_PERIOD_US);
+		GPIO_setupPinDirection(TWI_SCL_PORT_ID,TWI_SCL_PIN_ID,PIN_INPUT);
+		GPIO_writePin(TWI_SCL_PORT_ID,TWI_SCL_PIN_ID,LOGIC_HIGH);
+		_delay_us(TWI_RECOVERY_HALF_PERIOD_US);
+		GPIO_setupPinDirection(TWI_SDA_PORT_ID,TWI_SDA_PIN_ID,PIN_INPUT);
+		GPIO_writePin(TWI_SDA_PORT_ID,TWI_SDA_PIN_ID,LOGIC_HIGH);
+		_delay_us(TWI_RECOVERY_HALF_PERIOD_US);
+	}
+
+	/* Give the pins back to the TWI module at the bit rate in use */
+	TWI_enable();
+	g_twiError = TWI_ERROR_NONE;
+
+	return released;
+}
+
+boolean TWI_startTransfer(TWI_TransferType *transfer_Ptr)
+{
+	if(g_transferStatus == TWI_TRANSFER_BUSY)
+	{
+		return FALSE;
+	}
+	/* A new START must not overwrite the STOP of the previous transfer */
+	if(TWI_waitForStop() != TWI_ERROR_NONE)
+	{
+		TWI_recoverBus();
+	}
+	g_transfer_Ptr = transfer_Ptr;
+	g_writeIndex = 0;
+	g_readIndex = 0;
+	g_arbitrationRetries = TWI_ARBITRATION_RETRIES;
+	g_transferStatus = TWI_TRANSFER_BUSY;
+	/*
+	 * Send the start bit by TWSTA=1 with the TWI interrupt enabled TWIE=1,
+	 * the rest of the transfer continues inside TWI_vect
+	 */
+	TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN) | (1 << TWIE);
+	return TRUE;
+}
+
+TWI_TransferStatus TWI_getTransferStatus(void)
+{
+	return g_transferStatus;
+}
+
+TWI_TransferStatus TWI_waitTransfer(void)
+{
+	uint16 timeout = TWI_TIMEOUT_US;
+	uint8 events = g_transferEvents;
+
+	while(g_transferStatus == TWI_TRANSFER_BUSY)
+	{
+		if(events != g_transferEvents)
+		{
+			/* The transfer is progressing, restart the timeout */
+			events = g_transferEvents;
+			timeout = TWI_TIMEOUT_US;
+		}
+		else if(timeout == 0)
+		{
+			TWI_abortTransfer();
+		}
+		else
+		{
+			timeout--;
+			_delay_us(1);
+		}
+	}
+	return g_transferStatus;
+}
+
+void TWI_abortTransfer(void)
+{
+	uint8 sreg = SREG;
+
+	/* The TWI interrupt must not finish the transfer while it is aborted */
+	cli();
+	if(g_transferStatus == TWI_TRANSFER_BUSY)
+	{
+		TWCR = (1 << TWEN);
+		TWI_reportTransfer(TWI_TRANSFER_TIMEOUT);
+		SREG = sreg;
+		TWI_recoverBus();
+	}
+	else
+	{
+		SREG = sreg;
+	}
+}
+
+/*
+ * Description :
+ * Send the stop bit with the TWI interrupt disabled and report the result of the transfer.
+ */
+static void TWI_endTransfer(TWI_TransferStatus status)
+{
+	TWCR = (1 << TWINT) | (1 << TWSTO) | (1 << TWEN);
+	TWI_reportTransfer(status);
+}
+
+/*
+ * Description :
+ * Report the result of the transfer through the status and the call back.
+ */
+static void TWI_reportTransfer(TWI_TransferStatus status)
+{
+	g_transferStatus = status;
+	if(g_transfer_Ptr->callBack != NULL_PTR)
+	{
+		(*g_transfer_Ptr->callBack)(status);
+	}
+}
+
+/*
+ * Description :
+ * Wait for TWINT flag set in TWCR Register for TWI_TIMEOUT_US at most,
+ * then check the status for a lost arbitration or a bus error.
+ */
+static TWI_Error TWI_waitForFlag(void)
+{
+	uint16 timeout = TWI_TIMEOUT_US;
+
+	while(BIT_IS_CLEAR(TWCR,TWINT))
+	{
+		if(timeout == 0)
+		{
+			g_twiError = TWI_ERROR_TIMEOUT;
+			return g_twiError;
+		}
+		timeout--;
+		_delay_us(1);
+	}
+
+	switch(TWI_getStatus())
+	{
+	case TWI_ARB_LOST:
+		g_twiError = TWI_ERROR_ARBITRATION_LOST;
+		break;
+	case TWI_BUS_ERROR:
+		/* Release the lines and recover the TWI from the bus error TWSTO=1 */
+		TWCR = (1 << TWINT) | (1 << TWSTO) | (1 << TWEN);
+		g_twiError = TWI_ERROR_BUS;
+		break;
+	default:
+		g_twiError = TWI_ERROR_NONE;
+		break;
+	}
+	return g_twiError;
+}
+
+/*
+ * Description :
+ * Wait for TWSTO flag cleared by the hardware once the stop bit is on the bus.
+ */
+static TWI_Error TWI_waitForStop(void)
+{
+	uint16 timeout = TWI_TIMEOUT_US;
+
+	while(BIT_IS_SET(TWCR,TWSTO))
+	{
+		if(timeout == 0)
+		{
+			return TWI_ERROR_TIMEOUT;
+		}
+		timeout--;
+		_delay_us(1);
+	}
+	return TWI_ERROR_NONE;
+}
+
+/*
+ * Description :
+ * Select TWBR and the pre-scaler TWPS giving the fastest SCL frequency not above bit_rate:
+ * SCL frequency = F_CPU / (16 + 2 * TWBR * 4^TWPS)
+ */
+static void TWI_setBitRate(uint32 bit_rate)
+{
+	uint32 twbr = 0;
+	uint8 prescaler = 0;
+
+	if((bit_rate != 0) && ((16 * bit_rate) < F_CPU))
+	{
+		/* Round the division up so the generated frequency never exceeds the required one */
+		twbr = ((((F_CPU + bit_rate - 1) / bit_rate) - 16) + 1) / 2;
+	}
+	else if(bit_rate == 0)
+	{
+		twbr = 0xFFFFFFFFUL;
+	}
+
+	/* Use the pre-scaler (1, 4, 16, 64) while TWBR does not fit in 8 bits */
+	while((twbr > 0xFF) && (prescaler < 3))
+	{
+		twbr = (twbr + 3) / 4;
+		prescaler++;
+	}
+	if(twbr > 0xFF)
+	{
+		twbr = 0xFF;
+	}
+	if((prescaler == 0) && (twbr < TWI_MIN_TWBR))
+	{
+		twbr = TWI_MIN_TWBR;
+	}
+
+	g_twbr = (uint8)twbr;
+	g_twps = prescaler;
+	TWBR = g_twbr;
+	TWSR = g_twps;
+}
+
+/*
+ * Description :
+ * Enable the TWI module with the kept TWBR and TWPS and the address of the configuration.
+ */
+static void TWI_enable(void)
+{
+	TWBR = g_twbr;
+	TWSR = g_twps;
+	/* Two Wire Bus address my address if any master device want to call me: my address = g_twiConfig.address (used in case this MC is a slave device)
+       General Call Recognition: Off */
+	TWAR =  (g_twiConfig.address <<1) ; // my address = g_twiConfig.address (127:0)
+
+	TWCR = (1<<TWEN); /* enable TWI */
+}
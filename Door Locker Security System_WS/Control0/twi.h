@@ -19,16 +19,42 @@
  *                       definitions                                    *
  *******************************************************************************/
 
-typedef enum
-{
-	NORMAL_MODE_100_KB_PER_SEC,FAST_MODE_400_KB_PER_SEC
-}TWI_BaudRate;
+/* Standard bus speeds, any other SCL frequency in Hz can be requested */
+#define NORMAL_MODE_100_KB_PER_SEC     100000UL
+#define FAST_MODE_400_KB_PER_SEC       400000UL
+#define FAST_MODE_PLUS_1_MB_PER_SEC    1000000UL
 
 typedef struct{
 	uint8 address;
-	TWI_BaudRate bit_rate;
+	uint32 bit_rate; /* required SCL frequency in Hz, the nearest lower achievable one is used */
 }TWI_ConfigType;
 
+typedef enum
+{
+	TWI_TRANSFER_IDLE,TWI_TRANSFER_BUSY,TWI_TRANSFER_DONE,TWI_TRANSFER_NACK,TWI_TRANSFER_ERROR,
+	TWI_TRANSFER_ARB_LOST,TWI_TRANSFER_TIMEOUT
+}TWI_TransferStatus;
+
+typedef enum
+{
+	TWI_ERROR_NONE,TWI_ERROR_TIMEOUT,TWI_ERROR_ARBITRATION_LOST,TWI_ERROR_BUS
+}TWI_Error;
+
+/*
+ * Descriptor of one complete master transaction run by the TWI interrupt:
+ * START, SLA+W, write_data[], (repeated START, SLA+R, read_data[]), STOP.
+ * write_length = 0 and read_length = 0 only addresses the slave (ACK probe).
+ * The descriptor and its buffers must stay valid until the transfer ends.
+ */
+typedef struct{
+	uint8 slave_address; /* 7-bit slave address (127:0) */
+	const uint8 *write_data;
+	uint8 write_length;
+	uint8 *read_data;
+	uint8 read_length;
+	void (*callBack)(TWI_TransferStatus status); /* called from the ISR, may be NULL_PTR */
+}TWI_TransferType;
+
 
 /*******************************************************************************
  *                      Preprocessor Macros                                    *
@@ -42,17 +68,108 @@ typedef struct{
 #define TWI_MT_DATA_ACK   0x28 /* Master transmit data and ACK has been received from Slave. */
 #define TWI_MR_DATA_ACK   0x50 /* Master received data and send ACK to slave. */
 #define TWI_MR_DATA_NACK  0x58 /* Master received data but doesn't send ACK to slave. */
+#define TWI_MT_SLA_W_NACK 0x20 /* Master transmit ( slave address + Write request ) to slave + NACK received from slave. */
+#define TWI_MT_DATA_NACK  0x30 /* Master transmit data and NACK has been received from Slave. */
+#define TWI_MR_SLA_R_NACK 0x48 /* Master transmit ( slave address + Read request ) to slave + NACK received from slave. */
+#define TWI_ARB_LOST      0x38 /* Arbitration lost in SLA+R/W or data bytes. */
+#define TWI_BUS_ERROR     0x00 /* Bus error due to an illegal START or STOP condition. */
+
+/*
+ * SCL frequency = F_CPU / (16 + 2 * TWBR * 4^TWPS), the datasheet requires TWBR >= 10 in master mode
+ * so at F_CPU = 8Mhz the fastest bus is about 222 kb/s and Fast-mode-Plus can not be reached
+ */
+#define TWI_MIN_TWBR              10
+/* Number of consecutive ACKs the slave must give for a bit rate to be accepted by the probe */
+#define TWI_PROBE_ATTEMPTS        8
+
+/* Longest wait for one bus event (a byte at 100 kb/s takes 90us) before it is reported as a timeout */
+#define TWI_TIMEOUT_US            1000
+/* Number of START retries of an interrupt driven transfer after losing the arbitration */
+#define TWI_ARBITRATION_RETRIES   3
+
+/* TWI HW Ports and Pins, driven as GPIO by the bus recovery */
+#define TWI_SCL_PORT_ID           PORTC_ID
+#define TWI_SCL_PIN_ID            PIN0_ID
+#define TWI_SDA_PORT_ID           PORTC_ID
+#define TWI_SDA_PIN_ID            PIN1_ID
+
+/*
+ * Bus recovery: up to 9 SCL clocks make a slave that holds SDA low shift out the rest of its byte,
+ * Computed bound, not measured: the first half period, 9 periods of 10us and the STOP condition
+ * are 110us of delays, plus about 60 GPIO driver calls estimated at 20 cycles each, so the
+ * recovery stays under 300us at 8 MHz.
+ */
+#define TWI_RECOVERY_CLOCKS       9
+#define TWI_RECOVERY_HALF_PERIOD_US 5
 
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
 void TWI_init(const TWI_ConfigType * Config_Ptr);
-void TWI_start(void);
-void TWI_stop(void);
-void TWI_writeByte(uint8 data);
+TWI_Error TWI_start(void);
+TWI_Error TWI_stop(void);
+TWI_Error TWI_writeByte(uint8 data);
 uint8 TWI_readByteWithACK(void);
 uint8 TWI_readByteWithNACK(void);
 uint8 TWI_getStatus(void);
 
+/*
+ * Description :
+ * Return the error of the last blocking TWI operation (used after the read functions).
+ */
+TWI_Error TWI_getError(void);
+
+/*
+ * Description :
+ * Return the SCL frequency in Hz really generated by the current TWBR and prescaler.
+ * The value is rounded down, a TWI_init with it may select the next slower setting.
+ */
+uint32 TWI_getBitRate(void);
+
+/*
+ * Description :
+ * Find the fastest bit rate up to max_bit_rate at which the slave ACKs its address
+ * TWI_PROBE_ATTEMPTS times in a row, keep its TWBR and prescaler for the bus recoveries
+ * and return it.
+ * Return 0 and restore the previous bit rate if the slave never answers.
+ */
+uint32 TWI_probeMaxBitRate(uint8 slave_address,uint32 max_bit_rate);
+
+/*
+ * Description :
+ * Release a bus held by a slave: clock SCL manually until the slave frees SDA,
+ * generate a STOP condition and re-run TWI_init with the last configuration.
+ * Return TRUE if SDA is released.
+ */
+boolean TWI_recoverBus(void);
+
+/*
+ * Description :
+ * Start an interrupt driven transaction described by transfer_Ptr and return immediately.
+ * The whole START/SLA/data/STOP sequence is done inside TWI_vect, the end of the transfer
+ * is reported through the descriptor call back and through TWI_getTransferStatus().
+ * Return FALSE if another transfer is still running.
+ */
+boolean TWI_startTransfer(TWI_TransferType *transfer_Ptr);
+
+/*
+ * Description :
+ * Return the state of the last transfer started by TWI_startTransfer().
+ */
+TWI_TransferStatus TWI_getTransferStatus(void);
+
+/*
+ * Description :
+ * Wait for the running transfer to end and return its result. If the bus stays without
+ * any event for TWI_TIMEOUT_US the transfer is aborted and reported as TWI_TRANSFER_TIMEOUT.
+ */
+TWI_TransferStatus TWI_waitTransfer(void);
+
+/*
+ * Description :
+ * Abort the running transfer, report TWI_TRANSFER_TIMEOUT to its call back and recover the bus.
+ */
+void TWI_abortTransfer(void);
+
 
 #endif /* TWI_H_ */
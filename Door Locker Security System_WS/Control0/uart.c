@@ -11,6 +11,68 @@
 #include "uart.h"
 #include "avr/io.h" /* To use the UART Registers */
 #include "common_macros.h" /* To use the macros like SET_BIT */
+#include "idle.h"
+#include "tick.h"
+#include <avr/interrupt.h>
+
+/* error of the rate set by UART_init */
+static sint16 g_baudError = 0;
+/* receive errors since the last clear */
+static volatile UART_ErrorsType g_errors = {0,0,0};
+/* a byte was written to UDR since the last rate change, its end is seen on TXC */
+static boolean g_isSending = FALSE;
+/* Ring of the received bytes, filled by the receive interrupt and emptied by the readers */
+static volatile uint8 g_rxBuffer[UART_RX_BUFFER_SIZE];
+static volatile uint8 g_rxHead = 0;
+static volatile uint8 g_rxCount = 0;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static sint16 UART_baudError(uint32 baud_rate,uint8 divider,uint16 *ubrr_Ptr);
+static void UART_countError(volatile uint8 *counter_Ptr);
+static uint8 UART_readData(void);
+static uint8 UART_waitByte(uint32 start,uint16 timeout_ms);
+static void UART_sleepUntilByte(void);
+static boolean UART_isItemEnd(const UART_ParserType *parser_Ptr,uint8 data);
+
+/*******************************************************************************
+ *                              ISR                                    *
+ *******************************************************************************/
+
+/*
+ * A byte was received: keep it in the ring with the errors it came with, so no byte is
+ * lost while the main loop is busy. The interrupt also wakes the CPU from the idle sleep.
+ */
+ISR(USART_RXC_vect)
+{
+	/* the error flags belong to the byte in UDR, they must be read before it */
+	uint8 status = UCSRA;
+	uint8 data = UDR;
+
+	if(status & (1<<FE))
+	{
+		UART_countError(&g_errors.frame);
+	}
+	if(status & (1<<DOR))
+	{
+		UART_countError(&g_errors.overrun);
+	}
+	if(status & (1<<PE))
+	{
+		UART_countError(&g_errors.parity);
+	}
+
+	if(g_rxCount == UART_RX_BUFFER_SIZE)
+	{
+		/* full ring: the byte is lost like in a hardware overrun */
+		UART_countError(&g_errors.overrun);
+		return;
+	}
+	g_rxBuffer[(uint8)(g_rxHead + g_rxCount) % UART_RX_BUFFER_SIZE] = data;
+	g_rxCount++;
+}
 
 /*******************************************************************************
  *                      Functions Definitions                                  *
@@ -21,19 +83,29 @@
  * Functional responsible for Initialize the UART device by:
  * 1. Setup the Frame format like number of data bits, parity bit type and number of stop bits.
  * 2. Enable the UART.
- * 3. Setup the UART baud rate.
+ * 3. Setup the UART baud rate with the best UBRR and U2X.
+ * Return ERROR without touching the UART if the rate error is over UART_BAUD_ERROR_MAX.
  */
-void UART_init(const UART_ConfigType * Config_Ptr)
+uint8 UART_init(const UART_ConfigType * Config_Ptr)
 {
-	uint16 ubrr_value = 0;
+	UART_BaudType baud;
+
+	if(UART_computeBaud(Config_Ptr->baud_rate,&baud) == ERROR)
+	{
+		return ERROR;
+	}
+	g_baudError = baud.error;
+	g_isSending = FALSE;
 
-	/* U2X = 1 for double transmission speed */
-	UCSRA = (1<<U2X);
+	/* U2X = 1 for double transmission speed only when it gives the closer rate */
+	UCSRA = baud.isDoubleSpeed ? (1<<U2X) : 0;
 	/************************** UCSRB Description *************************
+	 * RXCIE = 1 Receive Complete Interrupt Enable, the bytes go to the ring
 	 * RXEN  = 1 Receiver Enable
 	 * RXEN  = 1 Transmitter Enable
 	 ***********************************************************************/ 
-	UCSRB = (1<<RXEN) | (1<<TXEN);
+	g_rxCount = 0;
+	UCSRB = (1<<RXCIE) | (1<<RXEN) | (1<<TXEN);
 
 	/* URSEL   = 1 The URSEL must be one when writing the UCSRC*/
 	UCSRC |= (1<<URSEL);
@@ -101,12 +173,236 @@ void UART_init(const UART_ConfigType * Config_Ptr)
 		break;
 	}
 
-	/* Calculate the UBRR register value */
-	ubrr_value = (uint16)(((F_CPU / (Config_Ptr->baud_rate * 8UL))) - 1);
-
 	/* First 8 bits from the BAUD_PRESCALE inside UBRRL and last 4 bits in UBRRH*/
-	UBRRH = ubrr_value>>8;
-	UBRRL = ubrr_value;
+	UBRRH = baud.ubrr>>8;
+	UBRRL = baud.ubrr;
+	return SUCCESS;
+}
+
+/*
+ * Description :
+ * Compute the UBRR and U2X giving the rate closest to baud_rate at F_CPU, and its error.
+ * Return ERROR if the error is over UART_BAUD_ERROR_MAX.
+ */
+uint8 UART_computeBaud(uint32 baud_rate,UART_BaudType *baud_Ptr)
+{
+	uint16 ubrrNormal,ubrrDouble;
+	sint16 errorNormal,errorDouble;
+
+	if(baud_rate == 0)
+	{
+		return ERROR;
+	}
+	/* 16 samples per bit, or 8 with U2X */
+	errorNormal = UART_baudError(baud_rate,16,&ubrrNormal);
+	errorDouble = UART_baudError(baud_rate,8,&ubrrDouble);
+
+	/* on a tie the normal speed wins, its 16 samples bear more clock error */
+	if(ABS(errorDouble) < ABS(errorNormal))
+	{
+		baud_Ptr->ubrr = ubrrDouble;
+		baud_Ptr->isDoubleSpeed = TRUE;
+		baud_Ptr->error = errorDouble;
+	}
+	else
+	{
+		baud_Ptr->ubrr = ubrrNormal;
+		baud_Ptr->isDoubleSpeed = FALSE;
+		baud_Ptr->error = errorNormal;
+	}
+	return (ABS(baud_Ptr->error) <= UART_BAUD_ERROR_MAX) ? SUCCESS : ERROR;
+}
+
+/*
+ * Description :
+ * Return the error of the rate set by UART_init, in 0.01% units.
+ */
+sint16 UART_getBaudError(void)
+{
+	return g_baudError;
+}
+
+/*
+ * Description :
+ * Change the baud rate once the bytes being sent are out, the bytes received at the old
+ * rate and the error counters are dropped. Return ERROR and keep the old rate if the
+ * rate error is over UART_BAUD_ERROR_MAX.
+ */
+uint8 UART_setBaudRate(uint32 baud_rate)
+{
+	UART_BaudType baud;
+	uint8 sreg;
+
+	if(UART_computeBaud(baud_rate,&baud) == ERROR)
+	{
+		return ERROR;
+	}
+
+	/* the last byte must leave the shift register at the old rate */
+	while(BIT_IS_CLEAR(UCSRA,UDRE)){}
+	if(g_isSending)
+	{
+		while(BIT_IS_CLEAR(UCSRA,TXC)){}
+		g_isSending = FALSE;
+	}
+
+	/* UCSRA is written whole so the TXC flag is cleared with the U2X change */
+	UCSRA = baud.isDoubleSpeed ? ((1<<U2X) | (1<<TXC)) : (1<<TXC);
+	UBRRH = baud.ubrr>>8;
+	UBRRL = baud.ubrr;
+	g_baudError = baud.error;
+
+	/* what came at the old rate is meaningless at the new one */
+	sreg = SREG;
+	cli();
+	while(BIT_IS_SET(UCSRA,RXC))
+	{
+		(void)UDR;
+	}
+	g_rxCount = 0;
+	SREG = sreg;
+	UART_clearErrors();
+	return SUCCESS;
+}
+
+/*
+ * Description :
+ * Give the receive errors counted since the last UART_clearErrors, each saturates at 255.
+ */
+void UART_getErrors(UART_ErrorsType *errors_Ptr)
+{
+	uint8 sreg = SREG;
+
+	/* the counters move in the receive interrupt */
+	cli();
+	errors_Ptr->frame = g_errors.frame;
+	errors_Ptr->overrun = g_errors.overrun;
+	errors_Ptr->parity = g_errors.parity;
+	SREG = sreg;
+}
+
+/*
+ * Description :
+ * Restart the receive error counters from zero.
+ */
+void UART_clearErrors(void)
+{
+	uint8 sreg = SREG;
+
+	cli();
+	g_errors.frame = 0;
+	g_errors.overrun = 0;
+	g_errors.parity = 0;
+	SREG = sreg;
+}
+
+/*
+ * Description :
+ * Count one more error without wrapping to zero.
+ */
+static void UART_countError(volatile uint8 *counter_Ptr)
+{
+	if(*counter_Ptr != 0xFF)
+	{
+		(*counter_Ptr)++;
+	}
+}
+
+/*
+ * Description :
+ * Take the oldest byte of the receive ring, there must be one.
+ */
+static uint8 UART_readData(void)
+{
+	uint8 data;
+	uint8 sreg = SREG;
+
+	cli();
+	data = g_rxBuffer[g_rxHead];
+	g_rxHead = (uint8)(g_rxHead + 1) % UART_RX_BUFFER_SIZE;
+	g_rxCount--;
+	SREG = sreg;
+	return data;
+}
+
+/*
+ * Description :
+ * Sleep until a byte is received or timeout_ms passed since start, the tick interrupt
+ * wakes the CPU each 1ms to check the deadline.
+ */
+static uint8 UART_waitByte(uint32 start,uint16 timeout_ms)
+{
+	while(g_rxCount == 0)
+	{
+		if((Tick_getMs() - start) >= timeout_ms)
+		{
+			return ERROR;
+		}
+		cli();
+		if(g_rxCount == 0)
+		{
+			Idle_sleep();
+		}
+		sei();
+	}
+	return SUCCESS;
+}
+
+/*
+ * Description :
+ * Wait until the receive interrupt puts a byte in the ring, sleeping until it wakes the CPU.
+ */
+static void UART_sleepUntilByte(void)
+{
+	while(g_rxCount == 0)
+	{
+		cli();
+		if(g_rxCount == 0)
+		{
+			Idle_sleep();
+		}
+		sei();
+	}
+}
+
+/*
+ * Description :
+ * The byte ends the item of the parser: a line ends at CR, LF or the delimiter,
+ * a token also at a space or a tab.
+ */
+static boolean UART_isItemEnd(const UART_ParserType *parser_Ptr,uint8 data)
+{
+	if((data == '\r') || (data == '\n') || (data == parser_Ptr->delimiter))
+	{
+		return TRUE;
+	}
+	if((parser_Ptr->mode == UART_PARSE_TOKENS) && ((data == ' ') || (data == '\t')))
+	{
+		return TRUE;
+	}
+	return FALSE;
+}
+
+/*
+ * Description :
+ * Rounded UBRR for one sampling divider and the error of the rate it gives in 0.01% units,
+ * a rate out of the 12 bits of UBRR gives the largest error.
+ */
+static sint16 UART_baudError(uint32 baud_rate,uint8 divider,uint16 *ubrr_Ptr)
+{
+	uint32 cycles = divider * baud_rate;
+	uint32 ubrrPlusOne = (F_CPU + (cycles / 2)) / cycles;
+	uint32 real;
+
+	if((ubrrPlusOne == 0) || (ubrrPlusOne > 4096))
+	{
+		*ubrr_Ptr = 0;
+		return 0x7FFF;
+	}
+	*ubrr_Ptr = (uint16)(ubrrPlusOne - 1);
+	/* real rate = F_CPU / (divider * (UBRR + 1)), compared to the requested one */
+	real = cycles * ubrrPlusOne;
+	return (sint16)((((sint32)F_CPU - (sint32)real) * 100) / (sint32)(real / 100));
 }
 
 /*
@@ -115,6 +411,8 @@ void UART_init(const UART_ConfigType * Config_Ptr)
  */
 void UART_sendByte(const uint8 data)
 {
+	uint8 sreg;
+
 	/*
 	 * UDRE flag is set when the Tx buffer (UDR) is empty and ready for
 	 * transmitting a new byte so wait until this flag is set to one
@@ -123,9 +421,15 @@ void UART_sendByte(const uint8 data)
 
 	/*
 	 * Put the required data in the UDR register and it also clear the UDRE flag as
-	 * the UDR register is not empty now
+	 * the UDR register is not empty now. TXC is cleared just before so it only tells
+	 * the end of this byte, without an interrupt in between
 	 */
+	sreg = SREG;
+	cli();
+	SET_BIT(UCSRA,TXC);
 	UDR = data;
+	SREG = sreg;
+	g_isSending = TRUE;
 
 	/************************* Another Method *************************
 	UDR = data;
@@ -154,14 +458,214 @@ void UART_sendArrayOfByte(const uint8 *data,uint8 length)
  */
 uint8 UART_recieveByte(void)
 {
-	/* RXC flag is set when the UART receive data so wait until this flag is set to one */
-	while(BIT_IS_CLEAR(UCSRA,RXC)){}
+	UART_sleepUntilByte();
 
-	/*
-	 * Read the received data from the Rx buffer (UDR)
-	 * The RXC flag will be cleared after read the data
-	 */
-	return UDR;
+	return UART_readData();
+}
+
+/*
+ * Description :
+ * Receive a byte waiting at most timeout_ms for it, 0 only takes a byte already there.
+ * Return ERROR if none came. The deadline runs on the system tick, Tick_init must be called.
+ */
+uint8 UART_recieveByteTimeout(uint8 *data_Ptr,uint16 timeout_ms)
+{
+	if(UART_waitByte(Tick_getMs(),timeout_ms) == ERROR)
+	{
+		return ERROR;
+	}
+	*data_Ptr = UART_readData();
+	return SUCCESS;
+}
+
+/*
+ * Description :
+ * Receive length bytes within timeout_ms for the whole array, received_Ptr gives the
+ * number of bytes that came. Return ERROR if the array is not complete at the deadline.
+ */
+uint8 UART_recieveArrayOfByteTimeout(uint8 *data,uint8 length,uint16 timeout_ms,uint8 *received_Ptr)
+{
+	uint32 start = Tick_getMs();
+	uint8 i;
+
+	for(i = 0 ; i < length ; i++)
+	{
+		if(UART_waitByte(start,timeout_ms) == ERROR)
+		{
+			break;
+		}
+		data[i] = UART_readData();
+	}
+	*received_Ptr = i;
+	return (i == length) ? SUCCESS : ERROR;
+}
+
+/*
+ * Description :
+ * Receive a string until '#' within timeout_ms, at most size - 1 characters then '\0'.
+ * received_Ptr gives the number of characters kept. Return ERROR at the deadline, what was
+ * received is kept terminated, or if the string does not fit, it is dropped up to its '#'.
+ * Return ERROR at once without touching Str if size is 0.
+ */
+uint8 UART_receiveStringTimeout(uint8 *Str,uint8 size,uint16 timeout_ms,uint8 *received_Ptr)
+{
+	uint32 start = Tick_getMs();
+	UART_ParserType parser;
+	UART_ParseStatus status;
+	uint8 result = SUCCESS;
+
+	/* no room for the '\0', size - 1 would wrap to 255 */
+	if(size == 0)
+	{
+		*received_Ptr = 0;
+		return ERROR;
+	}
+	UART_parserInit(&parser,Str,size,UART_PARSE_LINES,'#');
+	while(1)
+	{
+		status = UART_parse(&parser);
+		if(status == UART_PARSE_READY)
+		{
+			break;
+		}
+		if(status == UART_PARSE_TOO_LONG)
+		{
+			result = ERROR;
+		}
+		/* a too long string is dropped up to its '#' before the call returns */
+		if((result == ERROR) && (!parser.isDiscarding))
+		{
+			break;
+		}
+		if(UART_waitByte(start,timeout_ms) == ERROR)
+		{
+			/* what came before the deadline is kept */
+			result = ERROR;
+			parser.buffer[parser.length] = '\0';
+			break;
+		}
+	}
+	*received_Ptr = parser.length;
+	return result;
+}
+
+/*
+ * Description :
+ * Drop the rest of a broken exchange: the received bytes are read until the line stays
+ * quiet UART_RESYNC_IDLE_MS, or for UART_RESYNC_MAX_MS at most. Return the dropped bytes.
+ */
+uint16 UART_resync(void)
+{
+	uint32 start = Tick_getMs();
+	uint32 last = start;
+	uint16 dropped = 0;
+
+	while(((Tick_getMs() - last) < UART_RESYNC_IDLE_MS) && ((Tick_getMs() - start) < UART_RESYNC_MAX_MS))
+	{
+		/* wait for a byte until the next tick */
+		if(UART_waitByte(Tick_getMs(),1) == SUCCESS)
+		{
+			(void)UART_readData();
+			dropped++;
+			last = Tick_getMs();
+		}
+	}
+	return dropped;
+}
+
+/*
+ * Description :
+ * Return TRUE if a received byte is waiting, so the caller can poll without blocking.
+ */
+boolean UART_isByteReceived(void)
+{
+	/* the receive interrupt keeps the bytes in the ring until they are read */
+	return (g_rxCount != 0) ? TRUE : FALSE;
+}
+
+/*
+ * Description :
+ * Prepare a parser of the lines or tokens ended by CR, LF or delimiter (and a space or
+ * a tab for the tokens), which are received in buffer, size - 1 bytes at most.
+ * Return ERROR if size is 0: buffer has no room for the '\0', the parser gets no buffer.
+ */
+uint8 UART_parserInit(UART_ParserType *parser_Ptr,uint8 *buffer,uint8 size,UART_ParseMode mode,uint8 delimiter)
+{
+	parser_Ptr->buffer = (size == 0) ? NULL_PTR : buffer;
+	parser_Ptr->size = size;
+	parser_Ptr->length = 0;
+	parser_Ptr->delimiter = delimiter;
+	parser_Ptr->mode = mode;
+	parser_Ptr->isReady = FALSE;
+	parser_Ptr->isDiscarding = FALSE;
+	if(size == 0)
+	{
+		return ERROR;
+	}
+	buffer[0] = '\0';
+	return SUCCESS;
+}
+
+/*
+ * Description :
+ * Move the bytes already received into the parser buffer, UART_RX_BUFFER_SIZE at most,
+ * and return at once. UART_PARSE_READY: the buffer holds an item of length bytes ended by
+ * '\0', until the next call. UART_PARSE_TOO_LONG: an item went over size - 1 bytes, the
+ * rest of it is dropped up to its end. UART_PARSE_PENDING: the item is not complete yet.
+ */
+UART_ParseStatus UART_parse(UART_ParserType *parser_Ptr)
+{
+	uint8 data;
+
+	/* a parser without a buffer never receives an item */
+	if(parser_Ptr->size == 0)
+	{
+		return UART_PARSE_TOO_LONG;
+	}
+
+	/* the ready item was used by the caller, start the next one */
+	if(parser_Ptr->isReady)
+	{
+		parser_Ptr->isReady = FALSE;
+		parser_Ptr->length = 0;
+	}
+
+	for(uint8 i = 0; (i < UART_RX_BUFFER_SIZE) && (g_rxCount != 0); i++)
+	{
+		data = UART_readData();
+		if(UART_isItemEnd(parser_Ptr,data))
+		{
+			if(parser_Ptr->isDiscarding)
+			{
+				/* end of the too long item, the next one starts with the next call */
+				parser_Ptr->isDiscarding = FALSE;
+				return UART_PARSE_PENDING;
+			}
+			/* an empty line ended by the delimiter is an item ("#" is the empty string) */
+			if((parser_Ptr->length != 0) || ((parser_Ptr->mode == UART_PARSE_LINES) && (data == parser_Ptr->delimiter)))
+			{
+				parser_Ptr->buffer[parser_Ptr->length] = '\0';
+				parser_Ptr->isReady = TRUE;
+				return UART_PARSE_READY;
+			}
+			/* the other ends of an empty item, like the LF after a CR, are skipped */
+			continue;
+		}
+		if(parser_Ptr->isDiscarding)
+		{
+			continue;
+		}
+		if(parser_Ptr->length >= (uint8)(parser_Ptr->size - 1))
+		{
+			parser_Ptr->isDiscarding = TRUE;
+			parser_Ptr->length = 0;
+			parser_Ptr->buffer[0] = '\0';
+			return UART_PARSE_TOO_LONG;
+		}
+		parser_Ptr->buffer[parser_Ptr->length] = data;
+		parser_Ptr->length++;
+	}
+	return UART_PARSE_PENDING;
 }
 
 /*
@@ -201,22 +705,36 @@ void UART_sendString(const uint8 *Str)
 
 /*
  * Description :
- * Receive the required string until the '#' symbol through UART from the other UART device.
+ * Receive the required string until the '#' symbol through UART from the other UART device,
+ * at most size - 1 characters then '\0'. Return ERROR with an empty string if it did not
+ * fit, the rest of it is dropped up to its '#'. Return ERROR at once if size is 0.
  */
-void UART_receiveString(uint8 *Str)
+uint8 UART_receiveString(uint8 *Str,uint8 size)
 {
-	uint8 i = 0;
-
-	/* Receive the first byte */
-	Str[i] = UART_recieveByte();
+	UART_ParserType parser;
+	UART_ParseStatus status;
+	uint8 result = SUCCESS;
 
-	/* Receive the whole string until the '#' */
-	while(Str[i] != '#')
+	if(UART_parserInit(&parser,Str,size,UART_PARSE_LINES,'#') == ERROR)
 	{
-		i++;
-		Str[i] = UART_recieveByte();
+		return ERROR;
+	}
+	while(1)
+	{
+		status = UART_parse(&parser);
+		if(status == UART_PARSE_READY)
+		{
+			return result;
+		}
+		if(status == UART_PARSE_TOO_LONG)
+		{
+			result = ERROR;
+		}
+		/* a too long string is dropped up to its '#' before the call returns */
+		if((result == ERROR) && (!parser.isDiscarding))
+		{
+			return ERROR;
+		}
+		UART_sleepUntilByte();
 	}
-
-	/* After receiving the whole string plus the '#', replace the '#' with '\0' */
-	Str[i] = '\0';
 }
@@ -18,6 +18,27 @@
  *                       definitions                                    *
  *******************************************************************************/
 
+#ifndef SUCCESS
+#define ERROR 0
+#define SUCCESS 1
+#endif
+
+/*
+ * Largest baud rate error accepted, in 0.01% units. The datasheet allows about 2%
+ * for 8 data bits on the receiver, 1.5% leaves a margin for the clock of the other side.
+ */
+#define UART_BAUD_ERROR_MAX      150
+
+/*
+ * UART_resync drops bytes until the line is quiet this long, the bytes of a frame
+ * follow each other at once, and gives up after UART_RESYNC_MAX_MS of noise
+ */
+#define UART_RESYNC_IDLE_MS      20
+#define UART_RESYNC_MAX_MS       200
+
+/* received bytes kept by the receive interrupt until they are read, a power of 2 */
+#define UART_RX_BUFFER_SIZE      32
+
 typedef enum
 {
 	FIVE_BITS,SIX_BITS,SEVEN_BITS,EIGHT_BITS,NINE_BITS=7
@@ -41,6 +62,44 @@ typedef struct{
  uint32 baud_rate;
 }UART_ConfigType;
 
+typedef struct{
+ uint16 ubrr;
+ boolean isDoubleSpeed; /* U2X */
+ sint16 error;          /* real rate minus the requested one, in 0.01% units */
+}UART_BaudType;
+
+/* received bytes with a wrong stop bit, lost because UDR or the ring was full, or with a wrong parity */
+typedef struct{
+ uint8 frame;
+ uint8 overrun;
+ uint8 parity;
+}UART_ErrorsType;
+
+/* a line ends at CR, LF or the delimiter of the parser, a token also at a space or a tab */
+typedef enum
+{
+	UART_PARSE_LINES,UART_PARSE_TOKENS
+}UART_ParseMode;
+
+typedef enum
+{
+	UART_PARSE_PENDING,UART_PARSE_READY,UART_PARSE_TOO_LONG
+}UART_ParseStatus;
+
+/*
+ * Incremental parser of lines or tokens: the bytes go from the receive ring straight
+ * into buffer and a partial item waits there between the calls. Set by UART_parserInit.
+ */
+typedef struct{
+ uint8 *buffer;
+ uint8 size;            /* items are at most size - 1 bytes then '\0' */
+ uint8 length;          /* bytes of the item being received, or of the ready one */
+ uint8 delimiter;       /* end of item besides CR and LF, '#' for the strings of UART_sendString */
+ UART_ParseMode mode;
+ boolean isReady;
+ boolean isDiscarding;  /* the rest of a too long item is dropped up to its end */
+}UART_ParserType;
+
 
 /*******************************************************************************
  *                      Functions Prototypes                                   *
@@ -51,9 +110,43 @@ typedef struct{
  * Functional responsible for Initialize the UART device by:
  * 1. Setup the Frame format like number of data bits, parity bit type and number of stop bits.
  * 2. Enable the UART.
- * 3. Setup the UART baud rate.
+ * 3. Setup the UART baud rate with the best UBRR and U2X.
+ * Return ERROR without touching the UART if the rate error is over UART_BAUD_ERROR_MAX.
+ */
+uint8 UART_init(const UART_ConfigType * Config_Ptr);
+
+/*
+ * Description :
+ * Compute the UBRR and U2X giving the rate closest to baud_rate at F_CPU, and its error.
+ * Return ERROR if the error is over UART_BAUD_ERROR_MAX.
+ */
+uint8 UART_computeBaud(uint32 baud_rate,UART_BaudType *baud_Ptr);
+
+/*
+ * Description :
+ * Return the error of the rate set by UART_init, in 0.01% units.
+ */
+sint16 UART_getBaudError(void);
+
+/*
+ * Description :
+ * Change the baud rate once the bytes being sent are out, the bytes received at the old
+ * rate and the error counters are dropped. Return ERROR and keep the old rate if the
+ * rate error is over UART_BAUD_ERROR_MAX.
+ */
+uint8 UART_setBaudRate(uint32 baud_rate);
+
+/*
+ * Description :
+ * Give the receive errors counted since the last UART_clearErrors, each saturates at 255.
  */
-void UART_init(const UART_ConfigType * Config_Ptr);
+void UART_getErrors(UART_ErrorsType *errors_Ptr);
+
+/*
+ * Description :
+ * Restart the receive error counters from zero.
+ */
+void UART_clearErrors(void);
 
 /*
  * Description :
@@ -73,6 +166,62 @@ void UART_sendArrayOfByte(const uint8 *data,uint8 length);
  */
 uint8 UART_recieveByte(void);
 
+/*
+ * Description :
+ * Receive a byte waiting at most timeout_ms for it, 0 only takes a byte already there.
+ * Return ERROR if none came. The deadline runs on the system tick, Tick_init must be called.
+ */
+uint8 UART_recieveByteTimeout(uint8 *data_Ptr,uint16 timeout_ms);
+
+/*
+ * Description :
+ * Receive length bytes within timeout_ms for the whole array, received_Ptr gives the
+ * number of bytes that came. Return ERROR if the array is not complete at the deadline.
+ */
+uint8 UART_recieveArrayOfByteTimeout(uint8 *data,uint8 length,uint16 timeout_ms,uint8 *received_Ptr);
+
+/*
+ * Description :
+ * Receive a string until '#' within timeout_ms, at most size - 1 characters then '\0'.
+ * received_Ptr gives the number of characters kept. Return ERROR at the deadline, what was
+ * received is kept terminated, or if the string does not fit, it is dropped up to its '#'.
+ * Return ERROR at once without touching Str if size is 0.
+ */
+uint8 UART_receiveStringTimeout(uint8 *Str,uint8 size,uint16 timeout_ms,uint8 *received_Ptr);
+
+/*
+ * Description :
+ * Drop the rest of a broken exchange: the received bytes are read until the line stays
+ * quiet UART_RESYNC_IDLE_MS, or for UART_RESYNC_MAX_MS at most. Return the dropped bytes.
+ */
+uint16 UART_resync(void);
+
+/*
+ * Description :
+ * Return TRUE if a received byte is waiting, so the caller can poll without blocking.
+ */
+boolean UART_isByteReceived(void);
+
+/*
+ * Description :
+ * Prepare a parser of the lines or tokens ended by CR, LF or delimiter (and a space or
+ * a tab for the tokens), which are received in buffer, size - 1 bytes at most.
+ * A line ended by the delimiter may be empty, the other empty items are skipped.
+ * Return ERROR if size is 0: buffer has no room for the '\0', the parser gets no buffer
+ * and UART_parse only returns UART_PARSE_TOO_LONG.
+ */
+uint8 UART_parserInit(UART_ParserType *parser_Ptr,uint8 *buffer,uint8 size,UART_ParseMode mode,uint8 delimiter);
+
+/*
+ * Description :
+ * Move the bytes already received into the parser buffer, UART_RX_BUFFER_SIZE at most,
+ * and return at once. UART_PARSE_READY: the buffer holds an item of length bytes ended by
+ * '\0', until the next call. UART_PARSE_TOO_LONG: an item went over size - 1 bytes, the
+ * rest of it is dropped up to its end. UART_PARSE_PENDING: the item is not complete yet.
+ * It only reads the bytes the binary exchanges leave, so it can run between them.
+ */
+UART_ParseStatus UART_parse(UART_ParserType *parser_Ptr);
+
 /*
  * Description :
  * Functional responsible for receive array of bytes from another UART device.
@@ -88,8 +237,10 @@ void UART_sendString(const uint8 *Str);
 
 /*
  * Description :
- * Receive the required string until the '#' symbol through UART from the other UART device.
+ * Receive the required string until the '#' symbol through UART from the other UART device,
+ * at most size - 1 characters then '\0'. Return ERROR with an empty string if it did not
+ * fit, the rest of it is dropped up to its '#'. Return ERROR at once if size is 0.
  */
-void UART_receiveString(uint8 *Str); // Receive until #
+uint8 UART_receiveString(uint8 *Str,uint8 size); // Receive until #
 
 #endif /* UART_H_ */
@@ -0,0 +1,319 @@
+ /******************************************************************************
+ *
+ * Module: User Table
+ *
+ * File Name: user_table.c
+ *
+ * Description: Source file for the multi-user PIN table in the External EEPROM
+ *
+ *******************************************************************************/
+
+#include "user_table.h"
+#include "storage.h"
+#include "pin_hash.h"
+#include <util/crc16.h>
+
+/* Hash index: slot + 1 of each indexed user (0 = empty bucket) */
+static uint8 g_index[USER_INDEX_SIZE];
+/* Lookup tag of each used slot */
+static uint16 g_tags[USER_TABLE_MAX_USERS];
+/* Used slots */
+static uint8 g_used[(USER_TABLE_MAX_USERS + 7) / 8];
+/* Salt of the lookup tags, it is not the salt of any slot */
+static const uint8 g_tagSalt[PIN_HASH_SALT_SIZE] = USER_TABLE_TAG_SALT;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void UserTable_hash(uint8 slot,const UserTable_EntryType *entry_Ptr,const uint8 *pin,uint8 *hash);
+static uint8 UserTable_crc(const UserTable_EntryType *entry_Ptr);
+static uint16 UserTable_slotOffset(uint8 slot);
+static boolean UserTable_readEntry(uint8 slot,UserTable_EntryType *entry_Ptr);
+static uint8 UserTable_writeEntry(uint8 slot,UserTable_EntryType *entry_Ptr);
+static void UserTable_indexInsert(uint8 slot);
+static void UserTable_indexRebuild(void);
+static boolean UserTable_isUsed(uint8 slot);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void UserTable_init(void)
+{
+	UserTable_EntryType entry;
+
+	for(uint8 i = 0; i < sizeof(g_used); i++)
+	{
+		g_used[i] = 0;
+	}
+	for(uint8 i = 0; i < USER_INDEX_SIZE; i++)
+	{
+		g_index[i] = 0;
+	}
+
+	for(uint8 slot = 0; slot < USER_TABLE_MAX_USERS; slot++)
+	{
+		if(UserTable_readEntry(slot, &entry))
+		{
+			g_used[slot / 8] |= (1 << (slot % 8));
+			g_tags[slot] = entry.tag[0] | ((uint16)entry.tag[1] << 8);
+			UserTable_indexInsert(slot);
+		}
+	}
+}
+
+uint8 UserTable_add(const uint8 *pin, UserTable_Role role)
+{
+	UserTable_EntryType entry;
+	uint8 hash[PIN_HASH_SIZE];
+	uint8 random[PIN_HASH_SALT_SIZE];
+	uint16 tag = UserTable_tag(pin);
+
+	/* the tag must lead to one slot only */
+	if(UserTable_findTag(tag, &entry) != USER_NOT_FOUND)
+	{
+		return USER_NOT_FOUND;
+	}
+
+	for(uint8 slot = 0; slot < USER_TABLE_MAX_USERS; slot++)
+	{
+		if(!UserTable_isUsed(slot))
+		{
+			entry.flags = USER_FLAG_USED | USER_FLAG_ENABLED | USER_FLAG_SALTED;
+			if(role == USER_ROLE_ADMIN)
+			{
+				entry.flags |= USER_FLAG_ADMIN;
+			}
+			entry.tag[0] = (uint8)tag;
+			entry.tag[1] = (uint8)(tag >> 8);
+			PinHash_newSalt(random);
+			for(uint8 i = 0; i < USER_TABLE_SALT_SIZE; i++)
+			{
+				entry.salt[i] = random[i];
+			}
+			UserTable_hash(slot, &entry, pin, hash);
+			for(uint8 i = 0; i < USER_TABLE_HASH_SIZE; i++)
+			{
+				entry.hash[i] = hash[i];
+			}
+			if(UserTable_writeEntry(slot, &entry) == ERROR)
+			{
+				return USER_NOT_FOUND;
+			}
+
+			g_used[slot / 8] |= (1 << (slot % 8));
+			g_tags[slot] = tag;
+			UserTable_indexInsert(slot);
+			return slot;
+		}
+	}
+	return USER_NOT_FOUND;
+}
+
+uint8 UserTable_remove(uint8 slot)
+{
+	uint8 freeFlags = 0;
+
+	if((slot >= USER_TABLE_MAX_USERS) || (!UserTable_isUsed(slot)))
+	{
+		return ERROR;
+	}
+
+	/* Clearing the flags breaks the CRC so the slot reads as free */
+	if(Storage_write(STORAGE_USER_TABLE, UserTable_slotOffset(slot), &freeFlags, 1) == ERROR)
+	{
+		return ERROR;
+	}
+	g_used[slot / 8] &= ~(1 << (slot % 8));
+
+	/* Open addressing can not just empty a bucket, the probe chains are rebuilt */
+	UserTable_indexRebuild();
+	return SUCCESS;
+}
+
+uint8 UserTable_setEnabled(uint8 slot, boolean enabled)
+{
+	UserTable_EntryType entry;
+
+	if((slot >= USER_TABLE_MAX_USERS) || (!UserTable_readEntry(slot, &entry)))
+	{
+		return ERROR;
+	}
+
+	if(enabled)
+	{
+		entry.flags |= USER_FLAG_ENABLED;
+	}
+	else
+	{
+		entry.flags &= ~USER_FLAG_ENABLED;
+	}
+	return UserTable_writeEntry(slot, &entry);
+}
+
+uint8 UserTable_read(uint8 slot, UserTable_EntryType *entry_Ptr)
+{
+	/* free slots are known from RAM, only used ones cost an EEPROM read */
+	if((slot >= USER_TABLE_MAX_USERS) || (!UserTable_isUsed(slot)) || (!UserTable_readEntry(slot, entry_Ptr)))
+	{
+		return ERROR;
+	}
+	return SUCCESS;
+}
+
+uint8 UserTable_find(const uint8 *pin, UserTable_EntryType *entry_Ptr)
+{
+	uint8 hash[PIN_HASH_SIZE];
+	uint8 slot = UserTable_findTag(UserTable_tag(pin), entry_Ptr);
+
+	if(slot == USER_NOT_FOUND)
+	{
+		return USER_NOT_FOUND;
+	}
+	UserTable_hash(slot, entry_Ptr, pin, hash);
+	return PinHash_isEqual(entry_Ptr->hash, hash, USER_TABLE_HASH_SIZE) ? slot : USER_NOT_FOUND;
+}
+
+uint8 UserTable_findTag(uint16 tag, UserTable_EntryType *entry_Ptr)
+{
+	uint8 slot = UserTable_lookupTag(tag);
+
+	/* only the slot with the tag is read */
+	if((slot == USER_NOT_FOUND) || (!UserTable_readEntry(slot, entry_Ptr)))
+	{
+		return USER_NOT_FOUND;
+	}
+	return slot;
+}
+
+uint8 UserTable_lookupTag(uint16 tag)
+{
+	uint8 bucket = (uint8)(tag & (USER_INDEX_SIZE - 1));
+	uint8 slot;
+
+	/* Follow the probe chain until an empty bucket */
+	while(g_index[bucket] != 0)
+	{
+		slot = g_index[bucket] - 1;
+		if(g_tags[slot] == tag)
+		{
+			return slot;
+		}
+		bucket = (bucket + 1) & (USER_INDEX_SIZE - 1);
+	}
+	return USER_NOT_FOUND;
+}
+
+uint16 UserTable_tag(const uint8 *pin)
+{
+	uint8 hash[PIN_HASH_SIZE];
+
+	PinHash_compute(g_tagSalt, pin, USER_TABLE_PIN_SIZE, hash);
+	return hash[0] | ((uint16)hash[1] << 8);
+}
+
+void UserTable_getSalt(uint8 slot, const uint8 *entrySalt, uint8 *salt)
+{
+	salt[0] = slot;
+	for(uint8 i = 0; i < USER_TABLE_SALT_SIZE; i++)
+	{
+		salt[1 + i] = entrySalt[i];
+	}
+	for(uint8 i = 1 + USER_TABLE_SALT_SIZE; i < PIN_HASH_SALT_SIZE; i++)
+	{
+		salt[i] = 0;
+	}
+}
+
+/*
+ * Description :
+ * Hash a PIN with the salt of a slot.
+ */
+static void UserTable_hash(uint8 slot, const UserTable_EntryType *entry_Ptr, const uint8 *pin, uint8 *hash)
+{
+	uint8 salt[PIN_HASH_SALT_SIZE];
+
+	UserTable_getSalt(slot, entry_Ptr->salt, salt);
+	PinHash_compute(salt, pin, USER_TABLE_PIN_SIZE, hash);
+}
+
+/*
+ * Description :
+ * CRC-8 (polynomial 0x07) of the entry without its crc byte.
+ */
+static uint8 UserTable_crc(const UserTable_EntryType *entry_Ptr)
+{
+	const uint8 *bytes = (const uint8 *)entry_Ptr;
+	uint8 crc = 0;
+
+	for(uint8 i = 0; i < (sizeof(UserTable_EntryType) - 1); i++)
+	{
+		crc = _crc8_ccitt_update(crc, bytes[i]);
+	}
+	return crc;
+}
+
+static uint16 UserTable_slotOffset(uint8 slot)
+{
+	return ((uint16)slot * sizeof(UserTable_EntryType));
+}
+
+/*
+ * Description :
+ * Read one entry (one EEPROM block read), return TRUE if the slot holds a user.
+ */
+static boolean UserTable_readEntry(uint8 slot, UserTable_EntryType *entry_Ptr)
+{
+	if(Storage_read(STORAGE_USER_TABLE, UserTable_slotOffset(slot), (uint8 *)entry_Ptr, sizeof(UserTable_EntryType)) == ERROR)
+	{
+		return FALSE;
+	}
+	return ((entry_Ptr->flags & USER_FLAG_USED) && (entry_Ptr->flags & USER_FLAG_SALTED) &&
+			(entry_Ptr->crc == UserTable_crc(entry_Ptr)));
+}
+
+static uint8 UserTable_writeEntry(uint8 slot, UserTable_EntryType *entry_Ptr)
+{
+	entry_Ptr->crc = UserTable_crc(entry_Ptr);
+	return Storage_write(STORAGE_USER_TABLE, UserTable_slotOffset(slot), (const uint8 *)entry_Ptr, sizeof(UserTable_EntryType));
+}
+
+/*
+ * Description :
+ * Put a slot in the first empty bucket of the probe chain of its tag.
+ */
+static void UserTable_indexInsert(uint8 slot)
+{
+	uint8 bucket = (uint8)(g_tags[slot] & (USER_INDEX_SIZE - 1));
+
+	while(g_index[bucket] != 0)
+	{
+		bucket = (bucket + 1) & (USER_INDEX_SIZE - 1);
+	}
+	g_index[bucket] = slot + 1;
+}
+
+/*
+ * Description :
+ * Rebuild the index from the tags of the used slots after a removal.
+ */
+static void UserTable_indexRebuild(void)
+{
+	for(uint8 i = 0; i < USER_INDEX_SIZE; i++)
+	{
+		g_index[i] = 0;
+	}
+	for(uint8 slot = 0; slot < USER_TABLE_MAX_USERS; slot++)
+	{
+		if(UserTable_isUsed(slot))
+		{
+			UserTable_indexInsert(slot);
+		}
+	}
+}
+
+static boolean UserTable_isUsed(uint8 slot)
+{
+	return (g_used[slot / 8] & (1 << (slot % 8))) != 0;
+}
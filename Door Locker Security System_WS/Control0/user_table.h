@@ -0,0 +1,147 @@
+ /******************************************************************************
+ *
+ * Module: User Table
+ *
+ * File Name: user_table.h
+ *
+ * Description: Header file for the multi-user PIN table in the External EEPROM
+ *
+ *******************************************************************************/
+
+#ifndef USER_TABLE_H_
+#define USER_TABLE_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/*
+ * One 12 bytes slot per user, 64 users fill the STORAGE_USER_TABLE record. This is the
+ * limit of this board, not only of the record: the 2 KB 24C16 also holds the credential
+ * and audit logs, and 500 users would need 6 KB of entries plus a RAM index (1000 bytes
+ * of tags, 2 KB of 16 bit buckets) larger than the 2 KB RAM of the ATmega32. The slot
+ * numbers are 8 bit for that reason.
+ */
+#define USER_TABLE_MAX_USERS         64
+#define USER_TABLE_PIN_SIZE          5
+
+/*
+ * An entry keeps the first bytes of the PIN hash under its own salt, never the PIN.
+ * The salt of a slot is [slot][2 random bytes kept in the entry][0], so a PIN added
+ * again, on the same slot or on another one, does not get the same hash.
+ */
+#define USER_TABLE_HASH_SIZE         6
+#define USER_TABLE_SALT_SIZE         2
+
+/*
+ * Lookup tag: 16 bits of the PIN hash under USER_TABLE_TAG_SALT. It only finds the one
+ * slot to check (the tags of the users differ, a PIN whose tag is taken is refused),
+ * the salted hash of that slot decides. The first byte of the tag salt is never a slot.
+ */
+#define USER_TABLE_TAG_SALT          {0xFF,'T','A','G'}
+
+/*
+ * RAM hash index: open addressing table of slot numbers (power of 2, at most half full)
+ * plus the tag of each slot, so a PIN check costs about one index probe and only
+ * the slot with the tag is read from the EEPROM. A right PIN costs 2 hashes (tag and
+ * salted hash) and 1 EEPROM read, a wrong one 1 hash and a read only if its tag is taken.
+ */
+#define USER_INDEX_SIZE              128
+
+/* Entry flags */
+#define USER_FLAG_USED               0x01
+#define USER_FLAG_ENABLED            0x02
+#define USER_FLAG_ADMIN              0x04
+/* entry of this layout (tag and own salt), a slot without it is free */
+#define USER_FLAG_SALTED             0x10
+
+#define USER_NOT_FOUND               0xFF
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef enum
+{
+	USER_ROLE_USER,USER_ROLE_ADMIN
+}UserTable_Role;
+
+typedef struct{
+	uint8 flags;
+	uint8 tag[2]; /* little endian */
+	uint8 salt[USER_TABLE_SALT_SIZE];
+	uint8 hash[USER_TABLE_HASH_SIZE];
+	uint8 crc; /* CRC-8 of the previous bytes, a slot with a wrong CRC is free */
+}UserTable_EntryType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Read the whole table once and build the RAM hash index.
+ */
+void UserTable_init(void);
+
+/*
+ * Description :
+ * Store a new enabled user in the first free slot with a new salt and index it.
+ * Return the slot, or USER_NOT_FOUND if the table is full or the tag of the PIN is
+ * already used (the same PIN, or about one PIN in a thousand with 64 users).
+ */
+uint8 UserTable_add(const uint8 *pin,UserTable_Role role);
+
+/*
+ * Description :
+ * Free a slot and remove it from the index.
+ */
+uint8 UserTable_remove(uint8 slot);
+
+/*
+ * Description :
+ * Enable or disable a user without removing it.
+ */
+uint8 UserTable_setEnabled(uint8 slot,boolean enabled);
+
+/*
+ * Description :
+ * Read the entry of a used slot, return ERROR for a free one.
+ */
+uint8 UserTable_read(uint8 slot,UserTable_EntryType *entry_Ptr);
+
+/*
+ * Description :
+ * Look up a PIN: the tag hash, one index probe, at most one EEPROM block read and the
+ * salted hash of that slot, compared in constant time.
+ * Return the slot of the matching user (enabled or not), or USER_NOT_FOUND.
+ */
+uint8 UserTable_find(const uint8 *pin,UserTable_EntryType *entry_Ptr);
+
+/*
+ * Description :
+ * Return the slot holding a lookup tag and read its entry, or USER_NOT_FOUND.
+ */
+uint8 UserTable_findTag(uint16 tag,UserTable_EntryType *entry_Ptr);
+
+/*
+ * Description :
+ * Return the slot holding a lookup tag from the RAM index only, or USER_NOT_FOUND.
+ */
+uint8 UserTable_lookupTag(uint16 tag);
+
+/*
+ * Description :
+ * Compute the lookup tag of a PIN.
+ */
+uint16 UserTable_tag(const uint8 *pin);
+
+/*
+ * Description :
+ * Give the PIN_HASH_SALT_SIZE bytes salt of a slot from the salt bytes of its entry.
+ */
+void UserTable_getSalt(uint8 slot,const uint8 *entrySalt,uint8 *salt);
+
+#endif /* USER_TABLE_H_ */
@@ -0,0 +1,178 @@
+ /******************************************************************************
+ *
+ * Module: Watchdog
+ *
+ * File Name: watchdog.c
+ *
+ * Description: Source file for the watchdog supervision of the tasks
+ *
+ *******************************************************************************/
+
+#include "avr/io.h"
+#include "watchdog.h"
+#include "storage.h"
+#include "tick.h"
+#include <avr/interrupt.h>
+#include <avr/wdt.h>
+#include <util/crc16.h>
+
+typedef struct{
+	uint32 deadline_ms;
+	uint32 lastCheckIn;
+}Watchdog_TaskType;
+
+/* kept over a reset: not cleared by the startup code */
+static struct{
+	uint16 magic;
+	uint8 task;
+	uint8 head;
+	Watchdog_TraceType trace[WATCHDOG_TRACE_RECORDS];
+}g_noInit __attribute__((section(".noinit")));
+
+static volatile Watchdog_TaskType g_tasks[WATCHDOG_TASKS_NUMBER];
+static volatile uint8 g_tasksNumber = 0;
+static volatile boolean g_isExpired = FALSE;
+static uint8 g_cause = 0;
+static uint8 g_expiredTask = WATCHDOG_NO_TASK;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void Watchdog_supervise(void);
+static uint8 Watchdog_crc(const Watchdog_ReportType *report_Ptr);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void Watchdog_init(void)
+{
+	Watchdog_ReportType report;
+
+	g_cause = MCUCSR & (WATCHDOG_CAUSE_POWER_ON | WATCHDOG_CAUSE_EXTERNAL |
+			WATCHDOG_CAUSE_BROWN_OUT | WATCHDOG_CAUSE_WATCHDOG);
+	MCUCSR &= ~(WATCHDOG_CAUSE_POWER_ON | WATCHDOG_CAUSE_EXTERNAL |
+			WATCHDOG_CAUSE_BROWN_OUT | WATCHDOG_CAUSE_WATCHDOG);
+	wdt_disable();
+
+	/* the RAM is random after a power on, the trace is only meaningful after a watchdog reset */
+	if((g_cause & WATCHDOG_CAUSE_WATCHDOG) && (g_noInit.magic == WATCHDOG_TRACE_MAGIC))
+	{
+		g_expiredTask = g_noInit.task;
+		report.cause = g_cause;
+		report.task = g_noInit.task;
+		report.head = g_noInit.head % WATCHDOG_TRACE_RECORDS;
+		for(uint8 i = 0; i < WATCHDOG_TRACE_RECORDS; i++)
+		{
+			report.trace[i] = g_noInit.trace[i];
+		}
+		report.crc = Watchdog_crc(&report);
+		Storage_write(STORAGE_WATCHDOG, 0, (const uint8 *)&report, sizeof(report));
+	}
+
+	/* new trace for this run */
+	g_noInit.magic = WATCHDOG_TRACE_MAGIC;
+	g_noInit.task = WATCHDOG_NO_TASK;
+	g_noInit.head = 0;
+	for(uint8 i = 0; i < WATCHDOG_TRACE_RECORDS; i++)
+	{
+		g_noInit.trace[i].code = 0;
+		g_noInit.trace[i].ms = 0;
+	}
+}
+
+void Watchdog_start(void)
+{
+	wdt_enable(WATCHDOG_PERIOD);
+	Tick_addCallBack(Watchdog_supervise);
+}
+
+uint8 Watchdog_register(uint32 deadline_ms)
+{
+	uint8 task = WATCHDOG_NO_TASK;
+	uint8 sreg = SREG;
+
+	cli();
+	if(g_tasksNumber < WATCHDOG_TASKS_NUMBER)
+	{
+		task = g_tasksNumber;
+		g_tasks[task].deadline_ms = deadline_ms;
+		g_tasks[task].lastCheckIn = Tick_getMs();
+		g_tasksNumber++;
+	}
+	SREG = sreg;
+	return task;
+}
+
+void Watchdog_checkIn(uint8 task)
+{
+	uint8 sreg = SREG;
+
+	if(task >= WATCHDOG_TASKS_NUMBER)
+	{
+		return;
+	}
+	cli();
+	g_tasks[task].lastCheckIn = Tick_getMs();
+	SREG = sreg;
+}
+
+void Watchdog_trace(uint8 code)
+{
+	uint8 sreg = SREG;
+
+	cli();
+	g_noInit.trace[g_noInit.head].code = code;
+	g_noInit.trace[g_noInit.head].ms = (uint16)Tick_getMs();
+	g_noInit.head = (uint8)((g_noInit.head + 1) % WATCHDOG_TRACE_RECORDS);
+	SREG = sreg;
+}
+
+uint8 Watchdog_getResetCause(void)
+{
+	return g_cause;
+}
+
+uint8 Watchdog_getExpiredTask(void)
+{
+	return g_expiredTask;
+}
+
+/*
+ * Description :
+ * Executed each 1ms from the tick interrupt: feed the watchdog only if no task is late.
+ */
+static void Watchdog_supervise(void)
+{
+	uint32 now;
+
+	/* once a task is late the reset must come, even if it checks in again */
+	if(g_isExpired)
+	{
+		return;
+	}
+	now = Tick_getMs();
+	for(uint8 i = 0; i < g_tasksNumber; i++)
+	{
+		if((now - g_tasks[i].lastCheckIn) > g_tasks[i].deadline_ms)
+		{
+			g_isExpired = TRUE;
+			g_noInit.task = i;
+			return;
+		}
+	}
+	wdt_reset();
+}
+
+static uint8 Watchdog_crc(const Watchdog_ReportType *report_Ptr)
+{
+	const uint8 *bytes = (const uint8 *)report_Ptr;
+	uint8 crc = 0;
+
+	for(uint8 i = 0; i < (sizeof(Watchdog_ReportType) - 1); i++)
+	{
+		crc = _crc8_ccitt_update(crc, bytes[i]);
+	}
+	return crc;
+}
@@ -0,0 +1,108 @@
+ /******************************************************************************
+ *
+ * Module: Watchdog
+ *
+ * File Name: watchdog.h
+ *
+ * Description: Header file for the watchdog supervision of the tasks
+ *
+ *******************************************************************************/
+
+#ifndef WATCHDOG_H_
+#define WATCHDOG_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/*
+ * The AVR watchdog (about 2.1s at 5V) is fed from the 1ms tick only while every
+ * registered task has checked in within its deadline. A task that stops checking in
+ * gets the ECU reset after its deadline plus the watchdog period.
+ */
+#define WATCHDOG_PERIOD              WDTO_2S
+#define WATCHDOG_TASKS_NUMBER        4
+#define WATCHDOG_NO_TASK             0xFF
+
+/*
+ * The last trace records live in RAM that a reset does not clear. The ATmega32
+ * watchdog has no interrupt before the reset, so they are saved in the
+ * STORAGE_WATCHDOG record at the next boot, with the reset cause.
+ */
+#define WATCHDOG_TRACE_RECORDS       8
+#define WATCHDOG_TRACE_MAGIC         0x5A3C
+
+/* Reset cause bits, as in MCUCSR */
+#define WATCHDOG_CAUSE_POWER_ON      0x01
+#define WATCHDOG_CAUSE_EXTERNAL      0x02
+#define WATCHDOG_CAUSE_BROWN_OUT     0x04
+#define WATCHDOG_CAUSE_WATCHDOG      0x08
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef struct{
+	uint8 code;      /* what the ECU was doing, the command byte for the main loop */
+	uint16 ms;       /* low 16 bits of the tick time */
+}Watchdog_TraceType;
+
+typedef struct{
+	uint8 cause;     /* MCUCSR reset flags */
+	uint8 task;      /* task that missed its deadline, WATCHDOG_NO_TASK if none */
+	uint8 head;      /* next trace record to write, the oldest one */
+	Watchdog_TraceType trace[WATCHDOG_TRACE_RECORDS];
+	uint8 crc;       /* CRC-8 of the previous bytes */
+}Watchdog_ReportType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Read and clear the reset cause, it must be the first call of main.
+ * After a watchdog reset the trace kept in RAM is saved in STORAGE_WATCHDOG.
+ */
+void Watchdog_init(void);
+
+/*
+ * Description :
+ * Enable the watchdog and its supervision on the tick, call it at the end of the
+ * initialization, after Tick_init.
+ */
+void Watchdog_start(void);
+
+/*
+ * Description :
+ * Register a task that must check in at least each deadline_ms, return its id.
+ */
+uint8 Watchdog_register(uint32 deadline_ms);
+
+/*
+ * Description :
+ * The task is alive.
+ */
+void Watchdog_checkIn(uint8 task);
+
+/*
+ * Description :
+ * Add a record to the trace kept for the next boot.
+ */
+void Watchdog_trace(uint8 code);
+
+/*
+ * Description :
+ * Return the reset cause bits read by Watchdog_init.
+ */
+uint8 Watchdog_getResetCause(void);
+
+/*
+ * Description :
+ * Return the task that missed its deadline before the last reset, or WATCHDOG_NO_TASK.
+ */
+uint8 Watchdog_getExpiredTask(void);
+
+#endif /* WATCHDOG_H_ */
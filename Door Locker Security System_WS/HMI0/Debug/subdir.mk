@@ -5,26 +5,53 @@
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
 ../HMI_ECU.c \
+../baud.c \
+../chacha.c \
+../challenge.c \
 ../gpio.c \
+../idle.c \
+../internal_eeprom.c \
 ../keypad.c \
 ../lcd.c \
+../link.c \
+../siphash.c \
+../tick.c \
 ../timer1.c \
+../timer2.c \
 ../uart.c 
 
 OBJS += \
 ./HMI_ECU.o \
+./baud.o \
+./chacha.o \
+./challenge.o \
 ./gpio.o \
+./idle.o \
+./internal_eeprom.o \
 ./keypad.o \
 ./lcd.o \
+./link.o \
+./siphash.o \
+./tick.o \
 ./timer1.o \
+./timer2.o \
 ./uart.o 
 
 C_DEPS += \
 ./HMI_ECU.d \
+./baud.d \
+./chacha.d \
+./challenge.d \
 ./gpio.d \
+./idle.d \
+./internal_eeprom.d \
 ./keypad.d \
 ./lcd.d \
+./link.d \
+./siphash.d \
+./tick.d \
 ./timer1.d \
+./timer2.d \
 ./uart.d 
 
 
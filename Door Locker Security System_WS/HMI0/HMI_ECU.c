@@ -8,10 +8,19 @@
 #include "avr/io.h"
 #include <util/delay.h>
 #include"uart.h"
+#include "baud.h"
+#include "link.h"
+#include "idle.h"
+#include "tick.h"
+#include <avr/interrupt.h>
+#include "challenge.h"
 #include "timer1.h"
 
 
 #define MAX_DIGITS 					5
+/* frame of a new user: its PIN then its role, so the role is authenticated with the PIN */
+#define USER_FRAME_SIZE             (MAX_DIGITS + 1)
+#define USER_FRAME_ROLE_INDEX       MAX_DIGITS
 #define MATCHED 					1
 #define MISMATCHED 					0
 #define MC_ADDRESS 					0x0E1
@@ -20,12 +29,25 @@
 #define SENDING_SECOND_PASSWORD     0x0E
 #define OPEN_DOOR_MODE              0x0D
 #define CHANGE_PASSWORD		        0x0C
+#define ADD_USER                    0x0B
+#define REMOVE_USER                 0x0A
+#define EXPORT_AUDIT_LOG            0x06
+#define USER_ROLE_USER              0
+#define USER_ROLE_ADMIN             1
+/* exported audit log page: sequence(2) count(1) events(4*3) crc(1), event: [code:4|delta:12][delta][user] */
+#define AUDIT_PAGE_SIZE             16
+#define AUDIT_PAGE_COUNT_INDEX      2
+#define AUDIT_PAGE_EVENTS_INDEX     3
+#define AUDIT_EVENTS_PER_PAGE       4
+#define AUDIT_EVENT_SIZE            3
+#define AUDIT_EVENT_DOOR_OPENED     1
+#define AUDIT_EVENT_WRONG_PIN       2
+#define AUDIT_EVENT_TIME_GAP        15
 #define MAX_SPEED_FOR_DC_MOTER		100
 #define CTC_VALUE_FOR_ONE_SECOND 	7813
 #define CTC_INITIAL_VALUE 			0
-#define TIME_FOR_UNLOKING_THE_DOOR  15
-#define TIME_FOR_LOKING_THE_DOOR    15
 #define TIME_FOR_ERROR_MESSAGE      3
+#define LINK_SPEED_DISPLAY_TIME     1
 #define DOOR_HOLD_TIME              3
 #define BUZZER_ON                   0xB0
 #define BUZZER_OFF                  0xBF
@@ -33,11 +55,31 @@
 #define THERE_IS_PASSWORD_OR_NO     0x09
 #define THERE_IS_PASSWORD           0x08
 #define THERE_IS_NO_PASSWORD        0x07
-#define TRIES_NUMBER                3
+#define LOCKED_OUT                  0x05
+#define NOT_LOCKED_OUT              0x04
+#define DOOR_REPORT_AT_END          0x03
+#define DOOR_REPORT_JAMMED          0x02
+#define RESET_REPORT                0x10
+#define RESET_CAUSE_BROWN_OUT       0x04
+#define RESET_CAUSE_WATCHDOG        0x08
+/* Control_ECU answers an order within this, its EEPROM writes included */
+#define ANSWER_TIMEOUT_MS           1000
+/* the bytes following the first one of an answer come at once */
+#define RECEIVE_TIMEOUT_MS          200
+/* one door travel: the motor is cut after 15s, plus its ramps */
+#define DOOR_REPORT_TIMEOUT_MS      20000
 
 /*Global variables*/
 uint8 password[MAX_DIGITS]={0};
 uint8 password_check[MAX_DIGITS]={0};
+/* PIN of the user added to or removed from the user table, followed by the role of a new one */
+uint8 user_pin[USER_FRAME_SIZE]={0};
+/* one page of the audit log export */
+uint8 g_auditPage[AUDIT_PAGE_SIZE]={0};
+/* lookup tag of the password, open door challenge of Control_ECU and the answer to it */
+uint8 g_tag[CHALLENGE_TAG_SIZE]={0};
+uint8 g_challenge[CHALLENGE_SIZE]={0};
+uint8 g_response[CHALLENGE_RESPONSE_SIZE]={0};
 uint8 g_commandRececived=0;
 uint8 g_ticks=0;
 
@@ -78,14 +120,24 @@ void Step1_Create_System_Password()
 
 }
 
-/* function to display options Open the Door or Change Pass*/
+/* function to display options Open the Door, Change Pass or the user administration*/
 void Step2_Main_Options(void)
 {
 	LCD_clearScreen();
 	LCD_moveCursor(0,0);
-	LCD_displayString(" + : Open Door");
+	LCD_displayString("+:Open -:Change");
 	LCD_moveCursor(1,0);
-	LCD_displayString(" - : Change Pass ");
+	LCD_displayString("*:Users =:Log");
+}
+
+/* function to display the user administration options Add or Remove a user*/
+void showUserOptions(void)
+{
+	LCD_clearScreen();
+	LCD_moveCursor(0,0);
+	LCD_displayString(" + : Add User");
+	LCD_moveCursor(1,0);
+	LCD_displayString(" - : Remove User");
 }
 
 /*function to display enter password in lcd and take password from user*/
@@ -111,6 +163,42 @@ void takePasswordFromUser(void)
 }
 
 
+/*function to take the PIN of the user to add or remove*/
+void takeUserPinFromUser(void)
+{
+	LCD_clearScreen();
+	LCD_moveCursor(0,0);
+	LCD_displayString(" Plz Enter User");
+	LCD_moveCursor(1,0);
+	LCD_displayString("PIN: ");
+	/*Enter a PIN consists of 5 numbers, Display * in the screen for each number.*/
+	for(uint8 i=0;i<MAX_DIGITS;i++)
+	{
+		user_pin[i]=KEYPAD_getPressedKey();
+		LCD_displayCharacter('*');
+		_delay_ms(300);
+	}
+	/*wait for Press enter button*/
+	KEYPAD_getPressedKey();
+	_delay_ms(300);
+}
+
+/*function to take the role of the new user: + for a user, - for an admin*/
+uint8 takeUserRoleFromUser(void)
+{
+	uint8 key;
+
+	LCD_clearScreen();
+	LCD_moveCursor(0,0);
+	LCD_displayString(" + : User");
+	LCD_moveCursor(1,0);
+	LCD_displayString(" - : Admin");
+	key=KEYPAD_getPressedKey();
+	_delay_ms(300);
+	return (key=='-') ? USER_ROLE_ADMIN : USER_ROLE_USER;
+}
+
+
 /* this function is executed each 1 second*/
 void countOneSecond()
 {
@@ -127,7 +215,16 @@ void DelaySecondTimer1(uint8 timeSec)
 	/*Configuration For TIMER1 */
 	Timer1_init(&Config_Ptr1);
 	/* waiting for 15 seconds until the door is unlocking */
-	while (g_ticks < timeSec);
+	/* sleep between the timer interrupts */
+	while (g_ticks < timeSec)
+	{
+		cli();
+		if(g_ticks < timeSec)
+		{
+			Idle_sleep();
+		}
+		sei();
+	}
 	g_ticks = 0;
 	/* stop the timer1 */
 	Timer1_deInit();
@@ -135,39 +232,256 @@ void DelaySecondTimer1(uint8 timeSec)
 
 
 
+/* Control_ECU did not answer in time: drop the rest of the exchange and meet it again */
+void showLinkLost(void)
+{
+	LCD_clearScreen();
+	LCD_moveCursor(0,0);
+	LCD_displayString("   No Answer");
+	LCD_moveCursor(1,0);
+	LCD_displayString("  From Control");
+	DelaySecondTimer1(TIME_FOR_ERROR_MESSAGE);
+	/*late bytes of the broken exchange, then back to a rate both sides agree on*/
+	UART_resync();
+	Baud_negotiate();
+}
+
+/* receive the seconds before the next try from Control_ECU and display them */
+uint8 showRetryAfter(void)
+{
+	uint8 retryAfter[2];
+	uint8 received;
+
+	if(UART_recieveArrayOfByteTimeout(retryAfter,2,RECEIVE_TIMEOUT_MS,&received) == ERROR)
+	{
+		return ERROR;
+	}
+
+	LCD_clearScreen();
+	LCD_moveCursor(0,0);
+	if((retryAfter[0]==0) && (retryAfter[1]==0))
+	{
+		//display ERROR message,try again
+		LCD_displayString("   Mismatched");
+		LCD_moveCursor(1,0);
+		LCD_displayString("   Try Again");
+	}
+	else
+	{
+		/*the system is locked out, the message is shown for a few seconds only*/
+		LCD_displayString("  Locked Out");
+		LCD_moveCursor(1,0);
+		LCD_displayString("Retry in ");
+		LCD_intgerToString(retryAfter[0] | ((uint16)retryAfter[1]<<8));
+		LCD_displayString(" s");
+	}
+	DelaySecondTimer1(TIME_FOR_ERROR_MESSAGE);
+	return SUCCESS;
+}
+
+/* display the answer of Control_ECU to a user administration order */
+void showUserResult(uint8 result)
+{
+	LCD_clearScreen();
+	LCD_moveCursor(0,0);
+	if(result==MATCHED)
+	{
+		LCD_displayString("      Done");
+	}
+	else
+	{
+		/*wrong admin password, lockout, full table or unknown PIN*/
+		LCD_displayString("    Rejected");
+		LCD_moveCursor(1,0);
+		LCD_displayString("   Try Again");
+	}
+	DelaySecondTimer1(TIME_FOR_ERROR_MESSAGE);
+}
+
+/* receive the audit log exported by Control_ECU and display how many events it holds */
+uint8 showAuditLog(void)
+{
+	uint8 header[2];
+	uint16 pages;
+	uint16 events=0;
+	uint16 opened=0;
+	uint16 wrong=0;
+	uint8 code;
+
+	/*Control_ECU lets a running page write finish before the number of pages*/
+	if(Link_receive(header,2,ANSWER_TIMEOUT_MS) == ERROR)
+	{
+		return ERROR;
+	}
+	pages=header[0] | ((uint16)header[1]<<8);
+	/*the pages are streamed at once, oldest first, one encrypted frame each, and counted as they come*/
+	for(uint16 page=0;page<pages;page++)
+	{
+		if(Link_receive(g_auditPage,AUDIT_PAGE_SIZE,RECEIVE_TIMEOUT_MS) == ERROR)
+		{
+			return ERROR;
+		}
+		for(uint8 i=0;(i<g_auditPage[AUDIT_PAGE_COUNT_INDEX]) && (i<AUDIT_EVENTS_PER_PAGE);i++)
+		{
+			code=g_auditPage[AUDIT_PAGE_EVENTS_INDEX+(i*AUDIT_EVENT_SIZE)]>>4;
+			if(code==AUDIT_EVENT_TIME_GAP)
+			{
+				continue;
+			}
+			events++;
+			if(code==AUDIT_EVENT_DOOR_OPENED)
+			{
+				opened++;
+			}
+			else if(code==AUDIT_EVENT_WRONG_PIN)
+			{
+				wrong++;
+			}
+		}
+	}
+
+	LCD_clearScreen();
+	LCD_moveCursor(0,0);
+	LCD_displayString("Log Events: ");
+	LCD_intgerToString(events);
+	LCD_moveCursor(1,0);
+	LCD_displayString("Open ");
+	LCD_intgerToString(opened);
+	LCD_displayString(" Wrong ");
+	LCD_intgerToString(wrong);
+	DelaySecondTimer1(TIME_FOR_ERROR_MESSAGE);
+	return SUCCESS;
+}
+
+/* the door did not reach its end position in time */
+void showDoorJammed(void)
+{
+	LCD_clearScreen();
+	LCD_moveCursor(0,0);
+	LCD_displayString("  Door Jammed");
+	DelaySecondTimer1(TIME_FOR_ERROR_MESSAGE);
+}
+
+/* display the throughput Control_ECU measured at the negotiated rate, if it was measured */
+void showLinkSpeed(void)
+{
+	uint32 throughput=Baud_getThroughput();
+
+	if(throughput == 0)
+	{
+		return;
+	}
+	LCD_clearScreen();
+	LCD_moveCursor(0,0);
+	LCD_displayString("Link Speed:");
+	LCD_moveCursor(1,0);
+	/*at most 25000 bytes/s at BAUD_MAX_RATE, it fits the int of the LCD driver*/
+	LCD_intgerToString((int)throughput);
+	LCD_displayString(" B/s");
+	DelaySecondTimer1(LINK_SPEED_DISPLAY_TIME);
+}
+
+/* receive the cause of the last reset of Control_ECU, start a new link boot and display an abnormal one */
+uint8 showResetReport(void)
+{
+	uint8 report[2];
+	uint8 received;
+	uint8 cause;
+	uint8 task;
+
+	if(UART_recieveArrayOfByteTimeout(report,2,RECEIVE_TIMEOUT_MS,&received) == ERROR)
+	{
+		return ERROR;
+	}
+	cause=report[0];
+	task=report[1];
+	/*Control_ECU refuses the frames of the boots it served before its reset*/
+	Link_init(LINK_HMI);
+	if(!(cause & (RESET_CAUSE_WATCHDOG | RESET_CAUSE_BROWN_OUT)))
+	{
+		return SUCCESS;
+	}
+
+	LCD_clearScreen();
+	LCD_moveCursor(0,0);
+	LCD_displayString(" Control Reset");
+	LCD_moveCursor(1,0);
+	if(cause & RESET_CAUSE_WATCHDOG)
+	{
+		/*the task which stopped answering*/
+		LCD_displayString("Watchdog task ");
+		LCD_intgerToString(task);
+	}
+	else if(cause & RESET_CAUSE_BROWN_OUT)
+	{
+		LCD_displayString("  Brown-out");
+	}
+	DelaySecondTimer1(TIME_FOR_ERROR_MESSAGE);
+	return SUCCESS;
+}
+
 int main(void)
 {
-	/*variable to count user's tries in entering password  */
-	uint8 try=0;
 	/*variable takes + or - values*/
 	uint8 temp=0;
 	// Enable global interrupts
 	SREG=1<<7;
+	/* the waits for a byte, a key or a timer sleep instead of spinning */
+	Idle_init();
 	//select settings for uart
-	UART_ConfigType uart_config_1={EIGHT_BITS,DISABLED,ONE_BITS,9600};
+	UART_ConfigType uart_config_1={EIGHT_BITS,DISABLED,ONE_BITS,BAUD_SAFE_RATE};
 	UART_init(&uart_config_1);
+	/* time base of the receive deadlines */
+	Tick_init();
+	/* step up with Control_ECU to the fastest rate the wiring carries */
+	Baud_init(BAUD_HMI);
+	Baud_negotiate();
+	/* the passwords cross the wire encrypted and authenticated */
+	Link_init(LINK_HMI);
 	//select settings for LCD
 	LCD_init();
+	/* the bytes/s really reached on the wire, timed during the negotiation */
+	showLinkSpeed();
 
 	while(1)
 	{
+		/* negotiate again after receive errors or while Control_ECU never answered */
+		Baud_task();
 		/*ask Control if there is password or no */
 		UART_sendByte(THERE_IS_PASSWORD_OR_NO);
 		/*waiting for CONTROL to answer */
-		g_commandRececived=UART_recieveByte();
+		if(UART_recieveByteTimeout(&g_commandRececived,ANSWER_TIMEOUT_MS) == ERROR)
+		{
+			showLinkLost();
+			continue;
+		}
+		/*after a reset Control_ECU reports its cause before the answer*/
+		if(g_commandRececived==RESET_REPORT)
+		{
+			if((showResetReport() == ERROR) ||
+					(UART_recieveByteTimeout(&g_commandRececived,RECEIVE_TIMEOUT_MS) == ERROR))
+			{
+				showLinkLost();
+				continue;
+			}
+		}
 		if(g_commandRececived==THERE_IS_NO_PASSWORD)
 		{
 			/*Step1 – Create a System Password*/
 			Step1_Create_System_Password();
 			/*send the password*/
 			UART_sendByte(SENDING_FIRST_PASSWORD);
-			UART_sendArrayOfByte(password,MAX_DIGITS);
+			Link_send(password,MAX_DIGITS);
 			/*send the check password */
 			UART_sendByte(SENDING_SECOND_PASSWORD);
-			UART_sendArrayOfByte(password_check,MAX_DIGITS);
+			Link_send(password_check,MAX_DIGITS);
 
 			//receive command from conrol_ECU (matched or not)
-			g_commandRececived=UART_recieveByte();
+			if(UART_recieveByteTimeout(&g_commandRececived,ANSWER_TIMEOUT_MS) == ERROR)
+			{
+				showLinkLost();
+				continue;
+			}
 
 			//If the two passwords are unmatched then repeat step 1 again.
 			if(g_commandRececived==MISMATCHED)
@@ -199,61 +513,83 @@ int main(void)
 				takePasswordFromUser();
 				/*Send Command to Control_ECU to check the entered password*/
 				UART_sendByte(OPEN_DOOR_MODE);
-				/*Send the entered password*/
-				UART_sendArrayOfByte(password,MAX_DIGITS);
+				/*during a lockout Control_ECU answers at once with the time left*/
+				if(UART_recieveByteTimeout(&g_commandRececived,ANSWER_TIMEOUT_MS) == ERROR)
+				{
+					showLinkLost();
+					break;
+				}
+				if(g_commandRececived==LOCKED_OUT)
+				{
+					if(showRetryAfter() == ERROR)
+					{
+						showLinkLost();
+					}
+					break;
+				}
+				/*answer the challenge of Control_ECU: the password itself never leaves the HMI,
+				  its lookup tag tells Control_ECU which user salt to send*/
+				Challenge_tag(password,MAX_DIGITS,g_tag);
+				Link_send(g_tag,CHALLENGE_TAG_SIZE);
+				if(Link_receive(g_challenge,CHALLENGE_SIZE,ANSWER_TIMEOUT_MS) == ERROR)
+				{
+					showLinkLost();
+					break;
+				}
+				Challenge_respond(g_challenge,password,MAX_DIGITS,g_response);
+				Link_send(g_response,CHALLENGE_RESPONSE_SIZE);
 				/*Received from Control_ECU the result from comparing two passwords*/
-				g_commandRececived=UART_recieveByte();
+				if(UART_recieveByteTimeout(&g_commandRececived,ANSWER_TIMEOUT_MS) == ERROR)
+				{
+					showLinkLost();
+					break;
+				}
 				if(g_commandRececived==MATCHED)
 				{
-					/*display a message on the screen “Door is Unlocking” for 15 Seconds */
+					/*display a message on the screen “Door is Unlocking” until Control_ECU
+					  reports that the door reached the open switch */
 					LCD_clearScreen();
 					LCD_moveCursor(0,0);
 					LCD_displayString("    Door is");
 					LCD_moveCursor(1,0);
 					LCD_displayString("   Unlocking");
-
-					DelaySecondTimer1(TIME_FOR_UNLOKING_THE_DOOR);
-					/*display a message on the screen “Door is Unlocking” for 3 Seconds */
-					LCD_clearScreen();
-					LCD_moveCursor(0,0);
-					LCD_displayString("  Door is Open");
-					DelaySecondTimer1(DOOR_HOLD_TIME);
-					/*display a message on the screen “Door is locking” for 15 Seconds */
+					if(UART_recieveByteTimeout(&g_commandRececived,DOOR_REPORT_TIMEOUT_MS) == ERROR)
+					{
+						showLinkLost();
+						break;
+					}
+					if(g_commandRececived==DOOR_REPORT_AT_END)
+					{
+						/*display a message on the screen “Door is Open” for 3 Seconds */
+						LCD_clearScreen();
+						LCD_moveCursor(0,0);
+						LCD_displayString("  Door is Open");
+						DelaySecondTimer1(DOOR_HOLD_TIME);
+					}
+					else
+					{
+						showDoorJammed();
+					}
+					/*display a message on the screen “Door is locking” until the closed switch */
 					LCD_clearScreen();
 					LCD_moveCursor(0,0);
 					LCD_displayString("    Door is");
 					LCD_moveCursor(1,0);
 					LCD_displayString("     locking");
-					DelaySecondTimer1(TIME_FOR_LOKING_THE_DOOR);
-				}
-				else
-				{
-					/*increase the number of tries*/
-					try++;
-					if(try<TRIES_NUMBER)
+					if(UART_recieveByteTimeout(&g_commandRececived,DOOR_REPORT_TIMEOUT_MS) == ERROR)
 					{
-						//display ERROR message,try again
-						LCD_clearScreen();
-						LCD_moveCursor(0,0);
-						LCD_displayString("   Mismatched");
-						LCD_moveCursor(1,0);
-						LCD_displayString("   Try Again");
-						DelaySecondTimer1(TIME_FOR_ERROR_MESSAGE);
+						showLinkLost();
+						break;
 					}
-					if(try==TRIES_NUMBER)
+					if(g_commandRececived==DOOR_REPORT_JAMMED)
 					{
-						/* when numbers of tries=3 turn on the Buzzer*/
-						UART_sendByte(BUZZER_ON);
-						/*Display error message on LCD for 1 minute*/
-						LCD_clearScreen();
-						LCD_moveCursor(0,0);
-						LCD_displayString(" ERROR MESSAGE");
-						DelaySecondTimer1(BUZZER_ON_PERIOD);
-						try=0;
+						showDoorJammed();
 					}
-					else
-						/* else turn off the Buzzer*/
-						UART_sendByte(BUZZER_OFF);
+				}
+				/*Control_ECU counts the tries and tells how long to wait*/
+				else if(showRetryAfter() == ERROR)
+				{
+					showLinkLost();
 				}
 				break;
 
@@ -263,37 +599,72 @@ int main(void)
 				/*Select the Mode*/
 				UART_sendByte(CHANGE_PASSWORD);
 				/*Send the entered password*/
-				UART_sendArrayOfByte(password,MAX_DIGITS);
+				Link_send(password,MAX_DIGITS);
 				/*Received from Control_ECU the result from comparing two passwords*/
-				g_commandRececived=UART_recieveByte();
-				if(g_commandRececived==MISMATCHED)
+				if(UART_recieveByteTimeout(&g_commandRececived,ANSWER_TIMEOUT_MS) == ERROR)
 				{
-					/*increase the number of tries*/
-					try++;
-					if(try<TRIES_NUMBER)
-					{
-						//display ERROR message,try again
-						LCD_clearScreen();
-						LCD_moveCursor(0,0);
-						LCD_displayString("   Mismatched");
-						LCD_moveCursor(1,0);
-						LCD_displayString("   Try Again");
-						DelaySecondTimer1(TIME_FOR_ERROR_MESSAGE);
-					}
-					if(try==TRIES_NUMBER)
-					{
-						/* when numbers of tries=3 turn on the Buzzer*/
-						UART_sendByte(BUZZER_ON);
-						/*Display error message on LCD for 1 minute*/
-						LCD_clearScreen();
-						LCD_moveCursor(0,0);
-						LCD_displayString(" ERROR MESSAGE");
-						DelaySecondTimer1(BUZZER_ON_PERIOD);
-						try=0;
-					}
-					else
-						/* else turn off the Buzzer*/
-						UART_sendByte(BUZZER_OFF);
+					showLinkLost();
+					break;
+				}
+				/*mismatched or locked out: Control_ECU tells how long to wait*/
+				if((g_commandRececived!=MATCHED) && (showRetryAfter() == ERROR))
+				{
+					showLinkLost();
+				}
+				break;
+
+			case '*':
+				/*add or remove a user of the table, both need the password of an admin*/
+				showUserOptions();
+				temp=KEYPAD_getPressedKey();
+				_delay_ms(300);
+				if((temp!='+') && (temp!='-'))
+				{
+					break;
+				}
+				takePasswordFromUser();
+				takeUserPinFromUser();
+				if(temp=='+')
+				{
+					user_pin[USER_FRAME_ROLE_INDEX]=takeUserRoleFromUser();
+					/*admin password, then the new user PIN and its role in one frame*/
+					UART_sendByte(ADD_USER);
+					Link_send(password,MAX_DIGITS);
+					Link_send(user_pin,USER_FRAME_SIZE);
+				}
+				else
+				{
+					/*admin password then the PIN of the user to remove*/
+					UART_sendByte(REMOVE_USER);
+					Link_send(password,MAX_DIGITS);
+					Link_send(user_pin,MAX_DIGITS);
+				}
+				/*Control_ECU writes the user table before it answers*/
+				if(UART_recieveByteTimeout(&g_commandRececived,ANSWER_TIMEOUT_MS) == ERROR)
+				{
+					showLinkLost();
+					break;
+				}
+				showUserResult(g_commandRececived);
+				break;
+
+			case '=':
+				/*export the audit log of Control_ECU and display a summary of it, it needs the password of an admin*/
+				takePasswordFromUser();
+				UART_sendByte(EXPORT_AUDIT_LOG);
+				Link_send(password,MAX_DIGITS);
+				if(UART_recieveByteTimeout(&g_commandRececived,ANSWER_TIMEOUT_MS) == ERROR)
+				{
+					showLinkLost();
+					break;
+				}
+				if(g_commandRececived!=MATCHED)
+				{
+					showUserResult(g_commandRececived);
+				}
+				else if(showAuditLog() == ERROR)
+				{
+					showLinkLost();
 				}
 				break;
 			}
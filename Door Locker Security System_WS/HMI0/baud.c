@@ -0,0 +1,327 @@
+ /******************************************************************************
+ *
+ * Module: Baud
+ *
+ * File Name: baud.c
+ *
+ * Description: Source file for the baud rate negotiation between HMI and Control
+ *
+ *******************************************************************************/
+
+#include "baud.h"
+#include "uart.h"
+#include "tick.h"
+#include <util/delay.h>
+
+static const uint32 g_rates[BAUD_RATES_NUMBER] = BAUD_RATES;
+static const uint8 g_checkPattern[BAUD_CHECK_SIZE] = BAUD_CHECK_PATTERN;
+static Baud_Role g_role = BAUD_HMI;
+/* one bit per entry of g_rates this ECU offers, a rate that failed is dropped until the reset */
+static uint8 g_mask = 0;
+/* entry of g_rates in use */
+static uint8 g_index = 0;
+/* Control_ECU answered the last negotiation */
+static boolean g_isAnswered = FALSE;
+/* bytes/s measured at the rate in use, 0 if not measured */
+static uint32 g_throughput = 0;
+
+/* the agreed rate survives a watchdog reset so Control_ECU still talks to HMI_ECU after it */
+static struct{
+	uint8 index;
+	uint8 check;
+}g_kept __attribute__((section(".noinit")));
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void Baud_switch(uint8 index);
+static uint8 Baud_receive(uint8 *data,uint8 length);
+static uint8 Baud_highest(uint8 mask);
+static uint16 Baud_getErrors(void);
+static boolean Baud_isCheckRight(const uint8 *data);
+static void Baud_measure(void);
+static void Baud_measureAnswer(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void Baud_init(Baud_Role role)
+{
+	UART_BaudType baud;
+
+	g_role = role;
+	/* the safe rate is always offered, the others if this clock gives them */
+	g_mask = 1;
+	for(uint8 i = 1; i < BAUD_RATES_NUMBER; i++)
+	{
+		if((g_rates[i] <= BAUD_MAX_RATE) && (UART_computeBaud(g_rates[i], &baud) == SUCCESS))
+		{
+			g_mask |= (uint8)(1 << i);
+		}
+	}
+
+	/* RAM kept by the reset: HMI_ECU may still run at the last agreed rate */
+	if((role == BAUD_CONTROL) && ((uint8)(g_kept.check ^ g_kept.index) == 0xFF) &&
+			(g_kept.index < BAUD_RATES_NUMBER) && (g_mask & (1 << g_kept.index)))
+	{
+		Baud_switch(g_kept.index);
+	}
+	else
+	{
+		Baud_switch(0);
+	}
+}
+
+uint32 Baud_negotiate(void)
+{
+	uint8 mask = g_mask;
+	uint8 answer[2];
+	uint8 echo[BAUD_CHECK_SIZE];
+	uint8 attempts;
+	uint8 index;
+
+	while(1)
+	{
+		/* both sides meet at the safe rate */
+		Baud_switch(0);
+		for(attempts = 0; attempts < BAUD_HELLO_ATTEMPTS; attempts++)
+		{
+			UART_sendByte(BAUD_HELLO);
+			UART_sendByte(mask);
+			if((Baud_receive(answer, 2) == SUCCESS) && (answer[0] == BAUD_HELLO))
+			{
+				break;
+			}
+			/* drop the noise of a Control_ECU still at another rate */
+			Baud_switch(0);
+		}
+		g_isAnswered = (attempts < BAUD_HELLO_ATTEMPTS);
+		if(!g_isAnswered)
+		{
+			return g_rates[0];
+		}
+
+		/* both sides pick the same rate from the two masks */
+		index = Baud_highest(mask & answer[1]);
+		if(index == 0)
+		{
+			return g_rates[0];
+		}
+
+		/* Control_ECU switches once its answer is out */
+		_delay_ms(BAUD_SWITCH_DELAY_MS);
+		Baud_switch(index);
+		UART_sendArrayOfByte(g_checkPattern, BAUD_CHECK_SIZE);
+		if((Baud_receive(echo, BAUD_CHECK_SIZE) == SUCCESS) && Baud_isCheckRight(echo))
+		{
+			Baud_measure();
+			return g_rates[index];
+		}
+
+		/* the wiring does not carry this rate, try the next lower common one */
+		mask &= (uint8)~(1 << index);
+		g_mask = mask;
+	}
+}
+
+void Baud_answer(void)
+{
+	uint8 mask;
+	uint8 check[BAUD_CHECK_SIZE];
+	uint8 index;
+
+	if(Baud_receive(&mask, 1) == ERROR)
+	{
+		return;
+	}
+	UART_sendByte(BAUD_HELLO);
+	UART_sendByte(g_mask);
+
+	/* switch once the answer is out, HMI_ECU waits BAUD_SWITCH_DELAY_MS before the check */
+	index = Baud_highest(g_mask & mask);
+	Baud_switch(index);
+	if(index == 0)
+	{
+		return;
+	}
+
+	if((Baud_receive(check, BAUD_CHECK_SIZE) == SUCCESS) && Baud_isCheckRight(check))
+	{
+		UART_sendArrayOfByte(check, BAUD_CHECK_SIZE);
+		Baud_measureAnswer();
+		return;
+	}
+	/* HMI_ECU sees no echo and comes back to the safe rate with its next HELLO */
+	Baud_switch(0);
+}
+
+boolean Baud_task(void)
+{
+	if(Baud_getErrors() >= BAUD_ERRORS_MAX)
+	{
+		if(g_role == BAUD_CONTROL)
+		{
+			/* wait for HMI_ECU at the rate both sides start from */
+			Baud_switch(0);
+		}
+		else
+		{
+			/* the current rate is not offered again */
+			if(g_index != 0)
+			{
+				g_mask &= (uint8)~(1 << g_index);
+			}
+			Baud_negotiate();
+		}
+		return TRUE;
+	}
+	if((g_role == BAUD_HMI) && (!g_isAnswered))
+	{
+		Baud_negotiate();
+		return TRUE;
+	}
+	return FALSE;
+}
+
+uint32 Baud_getRate(void)
+{
+	return g_rates[g_index];
+}
+
+uint32 Baud_getThroughput(void)
+{
+	return g_throughput;
+}
+
+/*
+ * Description :
+ * Change the rate and keep it for a reset that does not clear the RAM.
+ */
+static void Baud_switch(uint8 index)
+{
+	UART_setBaudRate(g_rates[index]);
+	g_index = index;
+	g_throughput = 0;
+	g_kept.index = index;
+	g_kept.check = (uint8)~index;
+}
+
+/*
+ * Description :
+ * Receive length bytes within BAUD_TIMEOUT_MS.
+ */
+static uint8 Baud_receive(uint8 *data, uint8 length)
+{
+	uint8 received;
+
+	return UART_recieveArrayOfByteTimeout(data, length, BAUD_TIMEOUT_MS, &received);
+}
+
+/*
+ * Description :
+ * Entry of the fastest rate in a mask.
+ */
+static uint8 Baud_highest(uint8 mask)
+{
+	for(uint8 i = BAUD_RATES_NUMBER - 1; i > 0; i--)
+	{
+		if(mask & (1 << i))
+		{
+			return i;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Description :
+ * Receive errors since the last rate change.
+ */
+static uint16 Baud_getErrors(void)
+{
+	UART_ErrorsType errors;
+
+	UART_getErrors(&errors);
+	return (uint16)errors.frame + errors.overrun + errors.parity;
+}
+
+/*
+ * Description :
+ * HMI side: stream BAUD_MEASURE_SIZE bytes and receive the bytes/s Control_ECU measured.
+ */
+static void Baud_measure(void)
+{
+	uint8 result[4];
+	uint8 received;
+
+	for(uint16 i = 0; i < BAUD_MEASURE_SIZE; i++)
+	{
+		UART_sendByte(g_checkPattern[i % BAUD_CHECK_SIZE]);
+	}
+	/* Control_ECU answers once its receive of the last byte ends */
+	if(UART_recieveArrayOfByteTimeout(result, sizeof(result), 2 * BAUD_TIMEOUT_MS, &received) == SUCCESS)
+	{
+		g_throughput = result[0] | ((uint32)result[1] << 8) | ((uint32)result[2] << 16) | ((uint32)result[3] << 24);
+	}
+}
+
+/*
+ * Description :
+ * Control side: time the bytes streamed by HMI_ECU on the tick and send the bytes/s back,
+ * 0 if some of them did not come. Nothing is sent if the stream never starts: HMI_ECU
+ * did not get the echo and is back at BAUD_SAFE_RATE.
+ */
+static void Baud_measureAnswer(void)
+{
+	uint8 chunk[BAUD_MEASURE_CHUNK];
+	uint8 result[4];
+	uint8 received;
+	uint16 left = BAUD_MEASURE_SIZE - 1;
+	uint32 start;
+	uint32 elapsed;
+
+	g_throughput = 0;
+	/* the time runs from the first byte, so the wait for it is not counted */
+	if(Baud_receive(chunk, 1) == ERROR)
+	{
+		return;
+	}
+	start = Tick_getMs();
+	while(left > 0)
+	{
+		received = (left > BAUD_MEASURE_CHUNK) ? BAUD_MEASURE_CHUNK : (uint8)left;
+		if(Baud_receive(chunk, received) == ERROR)
+		{
+			break;
+		}
+		left -= received;
+	}
+	elapsed = Tick_getMs() - start;
+	if((left == 0) && (elapsed != 0))
+	{
+		g_throughput = (BAUD_MEASURE_SIZE - 1) * 1000UL / elapsed;
+	}
+	result[0] = (uint8)g_throughput;
+	result[1] = (uint8)(g_throughput >> 8);
+	result[2] = (uint8)(g_throughput >> 16);
+	result[3] = (uint8)(g_throughput >> 24);
+	UART_sendArrayOfByte(result, sizeof(result));
+}
+
+/*
+ * Description :
+ * The check bytes arrived unchanged and without a receive error.
+ */
+static boolean Baud_isCheckRight(const uint8 *data)
+{
+	for(uint8 i = 0; i < BAUD_CHECK_SIZE; i++)
+	{
+		if(data[i] != g_checkPattern[i])
+		{
+			return FALSE;
+		}
+	}
+	return (Baud_getErrors() == 0) ? TRUE : FALSE;
+}
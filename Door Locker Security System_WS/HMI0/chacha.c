@@ -0,0 +1,96 @@
+ /******************************************************************************
+ *
+ * Module: ChaCha
+ *
+ * File Name: chacha.c
+ *
+ * Description: Source file for the ChaCha8 stream cipher block function (128-bit key)
+ *
+ *******************************************************************************/
+
+#include "chacha.h"
+
+/*
+ * ChaCha only adds, xors and rotates 32-bit words: no table, so no cache or
+ * flash timing, and every rotation is a byte move plus at most 4 single-bit
+ * shifts on the AVR: 12 = 16 - 4 and 7 = 8 - 1.
+ */
+#define ROTL16(x)     (((x) << 16) | ((x) >> 16))
+#define ROTL8(x)      (((x) << 8) | ((x) >> 24))
+#define ROTR(x,b)     (((x) >> (b)) | ((x) << (32 - (b))))
+
+/* 8 rounds: 4 double rounds (columns then diagonals) */
+#define CHACHA_DOUBLE_ROUNDS         4
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void ChaCha_quarterRound(uint32 *x,uint8 a,uint8 b,uint8 c,uint8 d);
+static uint32 ChaCha_load(const uint8 *bytes);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void ChaCha_block(const uint8 *key, const uint8 *nonce, uint32 counter, uint8 *output)
+{
+	uint32 input[16];
+	uint32 x[16];
+	uint8 i;
+
+	/* "expand 16-byte k", the 128-bit key twice, block counter, nonce */
+	input[0] = 0x61707865UL;
+	input[1] = 0x3120646EUL;
+	input[2] = 0x79622D36UL;
+	input[3] = 0x6B206574UL;
+	for(i = 0; i < 4; i++)
+	{
+		input[4 + i] = ChaCha_load(key + (4 * i));
+		input[8 + i] = input[4 + i];
+	}
+	input[12] = counter;
+	input[13] = 0;
+	input[14] = ChaCha_load(nonce);
+	input[15] = ChaCha_load(nonce + 4);
+
+	for(i = 0; i < 16; i++)
+	{
+		x[i] = input[i];
+	}
+	for(i = 0; i < CHACHA_DOUBLE_ROUNDS; i++)
+	{
+		ChaCha_quarterRound(x, 0, 4, 8, 12);
+		ChaCha_quarterRound(x, 1, 5, 9, 13);
+		ChaCha_quarterRound(x, 2, 6, 10, 14);
+		ChaCha_quarterRound(x, 3, 7, 11, 15);
+		ChaCha_quarterRound(x, 0, 5, 10, 15);
+		ChaCha_quarterRound(x, 1, 6, 11, 12);
+		ChaCha_quarterRound(x, 2, 7, 8, 13);
+		ChaCha_quarterRound(x, 3, 4, 9, 14);
+	}
+
+	/* little endian output of the sum */
+	for(i = 0; i < 16; i++)
+	{
+		x[i] += input[i];
+		output[4 * i] = (uint8)x[i];
+		output[(4 * i) + 1] = (uint8)(x[i] >> 8);
+		output[(4 * i) + 2] = (uint8)(x[i] >> 16);
+		output[(4 * i) + 3] = (uint8)(x[i] >> 24);
+	}
+}
+
+static void ChaCha_quarterRound(uint32 *x, uint8 a, uint8 b, uint8 c, uint8 d)
+{
+	x[a] += x[b]; x[d] ^= x[a]; x[d] = ROTL16(x[d]);
+	x[c] += x[d]; x[b] ^= x[c]; x[b] = ROTL16(x[b]); x[b] = ROTR(x[b], 4);
+	x[a] += x[b]; x[d] ^= x[a]; x[d] = ROTL8(x[d]);
+	x[c] += x[d]; x[b] ^= x[c]; x[b] = ROTL8(x[b]); x[b] = ROTR(x[b], 1);
+}
+
+/* little endian 32-bit word */
+static uint32 ChaCha_load(const uint8 *bytes)
+{
+	return bytes[0] | ((uint32)bytes[1] << 8) | ((uint32)bytes[2] << 16) | ((uint32)bytes[3] << 24);
+}
@@ -0,0 +1,98 @@
+ /******************************************************************************
+ *
+ * Module: Challenge
+ *
+ * File Name: challenge.c
+ *
+ * Description: Source file for the challenge-response PIN check (HMI side)
+ *
+ *******************************************************************************/
+
+#include "challenge.h"
+#include "link.h"
+
+static const uint8 g_tagSalt[CHALLENGE_SALT_SIZE] = CHALLENGE_TAG_SALT;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void Challenge_hash(const uint8 *key,const uint8 *salt,const uint8 *pin,uint8 length,uint8 *hash);
+static void Challenge_mac(const uint8 *key,const uint8 *challenge,const uint8 *salt,const uint8 *pin,uint8 length,uint8 hashSize,uint8 *mac);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void Challenge_tag(const uint8 *pin, uint8 length, uint8 *tag)
+{
+	uint8 key[SIPHASH_KEY_SIZE];
+	uint8 hash[SIPHASH_OUTPUT_SIZE];
+
+	if(length > CHALLENGE_MAX_PIN_SIZE)
+	{
+		length = CHALLENGE_MAX_PIN_SIZE;
+	}
+	Link_deriveKey(LINK_LABEL_PIN_HASH, key, SIPHASH_KEY_SIZE);
+	Challenge_hash(key, g_tagSalt, pin, length, hash);
+	for(uint8 i = 0; i < CHALLENGE_TAG_SIZE; i++)
+	{
+		tag[i] = hash[i];
+	}
+}
+
+void Challenge_respond(const uint8 *challenge, const uint8 *pin, uint8 length, uint8 *response)
+{
+	uint8 key[SIPHASH_KEY_SIZE];
+
+	if(length > CHALLENGE_MAX_PIN_SIZE)
+	{
+		length = CHALLENGE_MAX_PIN_SIZE;
+	}
+	/* the device key of the stored hashes */
+	Link_deriveKey(LINK_LABEL_PIN_HASH, key, SIPHASH_KEY_SIZE);
+	/* one answer for the system password, one for the users */
+	Challenge_mac(key, challenge, challenge, pin, length, SIPHASH_OUTPUT_SIZE, response);
+	Challenge_mac(key, challenge, &challenge[CHALLENGE_SALT_SIZE], pin, length, CHALLENGE_USER_HASH_SIZE, &response[CHALLENGE_MAC_SIZE]);
+}
+
+/*
+ * Description :
+ * Hash salt + PIN with the device key, as Control_ECU does (pin_hash.c).
+ */
+static void Challenge_hash(const uint8 *key, const uint8 *salt, const uint8 *pin, uint8 length, uint8 *hash)
+{
+	uint8 message[CHALLENGE_SALT_SIZE + CHALLENGE_MAX_PIN_SIZE];
+
+	for(uint8 i = 0; i < CHALLENGE_SALT_SIZE; i++)
+	{
+		message[i] = salt[i];
+	}
+	for(uint8 i = 0; i < length; i++)
+	{
+		message[CHALLENGE_SALT_SIZE + i] = pin[i];
+	}
+	SipHash_compute(key, message, CHALLENGE_SALT_SIZE + length, hash);
+}
+
+/*
+ * Description :
+ * Keep the hashSize bytes of the salted hash Control_ECU stores and use them as the
+ * key of the MAC of the nonce.
+ */
+static void Challenge_mac(const uint8 *key, const uint8 *challenge, const uint8 *salt, const uint8 *pin, uint8 length, uint8 hashSize, uint8 *mac)
+{
+	uint8 hash[SIPHASH_OUTPUT_SIZE];
+	uint8 output[SIPHASH_OUTPUT_SIZE];
+
+	Challenge_hash(key, salt, pin, length, hash);
+	for(uint8 i = hashSize; i < SIPHASH_OUTPUT_SIZE; i++)
+	{
+		hash[i] = 0;
+	}
+	SipHash_compute(hash, &challenge[CHALLENGE_NONCE_INDEX], CHALLENGE_NONCE_SIZE, output);
+	for(uint8 i = 0; i < CHALLENGE_MAC_SIZE; i++)
+	{
+		mac[i] = output[i];
+	}
+}
@@ -0,0 +1,61 @@
+ /******************************************************************************
+ *
+ * Module: Challenge
+ *
+ * File Name: challenge.h
+ *
+ * Description: Header file for the challenge-response PIN check (HMI side)
+ *
+ *******************************************************************************/
+
+#ifndef CHALLENGE_H_
+#define CHALLENGE_H_
+
+#include "std_types.h"
+#include "siphash.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/*
+ * Request (one encrypted link frame): [lookup tag of the PIN:2]
+ * Challenge (one encrypted link frame): [system salt:4][user salt:4][nonce:4]
+ * Response: [MAC of the system password:4][MAC of the user PIN:4]
+ * The tag lets Control_ECU pick the one user slot whose salt it sends.
+ * A MAC is HalfSipHash keyed by the salted hash of the PIN over the nonce, the
+ * same hashes as the ones stored by Control_ECU (pin_hash.c and user_table.c).
+ * The device key of the hashes is derived from the link key on both sides.
+ */
+#define CHALLENGE_TAG_SIZE           2
+#define CHALLENGE_SALT_SIZE          4
+#define CHALLENGE_NONCE_SIZE         4
+#define CHALLENGE_MAC_SIZE           4
+#define CHALLENGE_NONCE_INDEX        (2 * CHALLENGE_SALT_SIZE)
+#define CHALLENGE_SIZE               (CHALLENGE_NONCE_INDEX + CHALLENGE_NONCE_SIZE)
+#define CHALLENGE_RESPONSE_SIZE      (2 * CHALLENGE_MAC_SIZE)
+#define CHALLENGE_MAX_PIN_SIZE       8
+
+/* salt of the lookup tags and stored hash size of the user table entries */
+#define CHALLENGE_TAG_SALT           {0xFF,'T','A','G'}
+#define CHALLENGE_USER_HASH_SIZE     6
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Compute the lookup tag of the PIN entered on the keypad, sent before the challenge.
+ * Must be called after Link_init.
+ */
+void Challenge_tag(const uint8 *pin,uint8 length,uint8 *tag);
+
+/*
+ * Description :
+ * Compute the response to a challenge for the PIN entered on the keypad.
+ * Must be called after Link_init.
+ */
+void Challenge_respond(const uint8 *challenge,const uint8 *pin,uint8 length,uint8 *response);
+
+#endif /* CHALLENGE_H_ */
@@ -0,0 +1,32 @@
+ /******************************************************************************
+ *
+ * Module: Idle
+ *
+ * File Name: idle.c
+ *
+ * Description: Source file for the idle sleep of the ECU
+ *
+ *******************************************************************************/
+
+#include "avr/io.h"
+#include "idle.h"
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void Idle_init(void)
+{
+	set_sleep_mode(SLEEP_MODE_IDLE);
+}
+
+void Idle_sleep(void)
+{
+	sleep_enable();
+	/* the instruction after sei is always executed before a pending interrupt */
+	sei();
+	sleep_cpu();
+	sleep_disable();
+}
@@ -0,0 +1,129 @@
+ /******************************************************************************
+ *
+ * Module: Internal EEPROM
+ *
+ * File Name: internal_eeprom.c
+ *
+ * Description: Source file for the ATmega32 internal EEPROM driver
+ *
+ *******************************************************************************/
+
+#include "avr/io.h"
+#include "internal_eeprom.h"
+#include "common_macros.h"
+#include <avr/interrupt.h>
+#include <avr/eeprom.h>
+
+/* Ring of the bytes waiting to be programmed, filled by writeBlock and emptied by the ISR */
+static volatile uint16 g_queueAddress[INTERNAL_EEPROM_QUEUE_SIZE];
+static volatile uint8 g_queueData[INTERNAL_EEPROM_QUEUE_SIZE];
+static volatile uint8 g_queueHead = 0;
+static volatile uint8 g_queueCount = 0;
+
+/*******************************************************************************
+ *                              ISR                                    *
+ *******************************************************************************/
+
+/* The EEPROM finished the previous byte: program the next one of the queue */
+ISR(EE_READY_vect)
+{
+	if(g_queueCount == 0)
+	{
+		/* nothing left, the interrupt is enabled again by the next write */
+		CLEAR_BIT(EECR,EERIE);
+		return;
+	}
+
+	/* eeprom_write_byte keeps the EEMWE/EEWE sequence inside the 4 cycles limit */
+	eeprom_write_byte((uint8 *)g_queueAddress[g_queueHead], g_queueData[g_queueHead]);
+	g_queueHead = (uint8)((g_queueHead + 1) % INTERNAL_EEPROM_QUEUE_SIZE);
+	g_queueCount--;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+uint8 InternalEEPROM_readBlock(uint16 address, uint8 *data, uint16 length)
+{
+	uint8 sreg;
+	uint8 index;
+	boolean isQueueRunning;
+
+	if(((uint32)address + length) > INTERNAL_EEPROM_SIZE)
+	{
+		return ERROR;
+	}
+
+	/*
+	 * Hold the queue for the whole read: the ISR would otherwise program a byte, or change
+	 * EEAR, between the hardware reads and the overlay of the queue below
+	 */
+	sreg = SREG;
+	cli();
+	isQueueRunning = BIT_IS_SET(EECR,EERIE);
+	CLEAR_BIT(EECR,EERIE);
+	SREG = sreg;
+
+	/* waits only for the byte being programmed now, if any */
+	for(uint16 i = 0; i < length; i++)
+	{
+		data[i] = eeprom_read_byte((const uint8 *)(address + i));
+	}
+
+	/* Apply the queued bytes from the oldest to the newest so the last write wins */
+	cli();
+	for(uint8 i = 0; i < g_queueCount; i++)
+	{
+		index = (uint8)((g_queueHead + i) % INTERNAL_EEPROM_QUEUE_SIZE);
+		if((g_queueAddress[index] >= address) && (g_queueAddress[index] < (address + length)))
+		{
+			data[g_queueAddress[index] - address] = g_queueData[index];
+		}
+	}
+	/* let the queue go on */
+	if(isQueueRunning)
+	{
+		SET_BIT(EECR,EERIE);
+	}
+	SREG = sreg;
+	return SUCCESS;
+}
+
+uint8 InternalEEPROM_writeBlock(uint16 address, const uint8 *data, uint16 length)
+{
+	uint8 current;
+	uint8 sreg;
+
+	if(((uint32)address + length) > INTERNAL_EEPROM_SIZE)
+	{
+		return ERROR;
+	}
+
+	for(uint16 i = 0; i < length; i++)
+	{
+		/* a byte that already holds the value costs neither time nor wear */
+		InternalEEPROM_readBlock(address + i, &current, 1);
+		if(current == data[i])
+		{
+			continue;
+		}
+
+		/* wait for the interrupt to free a place in a full queue */
+		while(g_queueCount == INTERNAL_EEPROM_QUEUE_SIZE);
+
+		sreg = SREG;
+		cli();
+		g_queueAddress[(g_queueHead + g_queueCount) % INTERNAL_EEPROM_QUEUE_SIZE] = address + i;
+		g_queueData[(g_queueHead + g_queueCount) % INTERNAL_EEPROM_QUEUE_SIZE] = data[i];
+		g_queueCount++;
+		SET_BIT(EECR,EERIE);
+		SREG = sreg;
+	}
+	return SUCCESS;
+}
+
+boolean InternalEEPROM_isBusy(void)
+{
+	return ((g_queueCount != 0) || BIT_IS_SET(EECR,EEWE));
+}
@@ -0,0 +1,56 @@
+ /******************************************************************************
+ *
+ * Module: Internal EEPROM
+ *
+ * File Name: internal_eeprom.h
+ *
+ * Description: Header file for the ATmega32 internal EEPROM driver
+ *
+ *******************************************************************************/
+
+#ifndef INTERNAL_EEPROM_H_
+#define INTERNAL_EEPROM_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+#ifndef SUCCESS
+#define ERROR 0
+#define SUCCESS 1
+#endif
+
+#define INTERNAL_EEPROM_SIZE         1024
+
+/*
+ * Bytes waiting for the EE_READY interrupt, one byte write takes about 8.5ms
+ * so a write call returns at once and the bytes are programmed in the background
+ */
+#define INTERNAL_EEPROM_QUEUE_SIZE   32
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Read a block, the bytes still waiting in the write queue are returned with their new value.
+ * The queue is held during the read so the result is one consistent state.
+ */
+uint8 InternalEEPROM_readBlock(uint16 address,uint8 *data,uint16 length);
+
+/*
+ * Description :
+ * Queue the changed bytes of a block for the EE_READY interrupt and return,
+ * it only waits if the queue is full. Unchanged bytes are not written again.
+ */
+uint8 InternalEEPROM_writeBlock(uint16 address,const uint8 *data,uint16 length);
+
+/*
+ * Description :
+ * Return TRUE while queued bytes are still being programmed.
+ */
+boolean InternalEEPROM_isBusy(void);
+
+#endif /* INTERNAL_EEPROM_H_ */
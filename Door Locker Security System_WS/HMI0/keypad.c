@@ -11,6 +11,18 @@
 #include "keypad.h"
 #include "gpio.h"
 #include <util/delay.h>
+#if KEYPAD_WAKE_ON_INT2
+#include "avr/io.h"
+#include "common_macros.h"
+#include "idle.h"
+#include <avr/interrupt.h>
+
+/* time of one scan of the matrix, 5ms for each row */
+#define KEYPAD_SCAN_MS                    (KEYPAD_NUM_ROWS * 5)
+
+static boolean g_isScanning = FALSE;
+static uint16 g_idleScans = 0;
+#endif
 
 /*******************************************************************************
  *                      Functions Prototypes(Private)                          *
@@ -34,6 +46,55 @@ static uint8 KEYPAD_4x4_adjustKeyNumber(uint8 button_number);
 
 #endif /* STANDARD_KEYPAD */
 
+#if KEYPAD_WAKE_ON_INT2
+/*******************************************************************************
+ *                              ISR                                    *
+ *******************************************************************************/
+
+/* the first press only wakes the CPU, the matrix scan finds the key */
+ISR(INT2_vect)
+{
+	CLEAR_BIT(GICR,INT2);
+}
+
+/*
+ * Drive all the rows low and sleep until a press pulls INT2 low
+ */
+static void KEYPAD_waitFirstPress(void)
+{
+	uint8 row;
+
+	for(row=0 ; row<KEYPAD_NUM_ROWS ; row++)
+	{
+		GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID,KEYPAD_FIRST_ROW_PIN_ID+row,PIN_OUTPUT);
+		GPIO_writePin(KEYPAD_ROW_PORT_ID,KEYPAD_FIRST_ROW_PIN_ID+row,KEYPAD_BUTTON_PRESSED);
+	}
+	GPIO_setupPinDirection(KEYPAD_WAKE_PORT_ID,KEYPAD_WAKE_PIN_ID,PIN_INPUT);
+	GPIO_writePin(KEYPAD_WAKE_PORT_ID,KEYPAD_WAKE_PIN_ID,LOGIC_HIGH);
+
+	/* INT2 on the falling edge ISC2=0, ISC2 is changed with INT2 disabled as the datasheet asks */
+	CLEAR_BIT(GICR,INT2);
+	CLEAR_BIT(MCUCSR,ISC2);
+	SET_BIT(GIFR,INTF2);
+
+	/* a key already down gives no edge, and another interrupt must not end the wait */
+	cli();
+	while(GPIO_readPin(KEYPAD_WAKE_PORT_ID,KEYPAD_WAKE_PIN_ID) != KEYPAD_BUTTON_PRESSED)
+	{
+		SET_BIT(GICR,INT2);
+		Idle_sleep();
+		cli();
+	}
+	sei();
+	CLEAR_BIT(GICR,INT2);
+
+	for(row=0 ; row<KEYPAD_NUM_ROWS ; row++)
+	{
+		GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID,KEYPAD_FIRST_ROW_PIN_ID+row,PIN_INPUT);
+	}
+}
+#endif
+
 /*******************************************************************************
  *                      Functions Definitions                                  *
  *******************************************************************************/
@@ -54,6 +115,15 @@ uint8 KEYPAD_getPressedKey(void)
 #endif
 	while(1)
 	{
+#if KEYPAD_WAKE_ON_INT2
+		/* no scan at all until somebody presses a key */
+		if(!g_isScanning)
+		{
+			KEYPAD_waitFirstPress();
+			g_isScanning = TRUE;
+			g_idleScans = 0;
+		}
+#endif
 		for(row=0 ; row<KEYPAD_NUM_ROWS ; row++) /* loop for rows */
 		{
 			/* 
@@ -70,6 +140,9 @@ uint8 KEYPAD_getPressedKey(void)
 				/* Check if the switch is pressed in this column */
 				if(GPIO_readPin(KEYPAD_COL_PORT_ID,KEYPAD_FIRST_COL_PIN_ID+col) == KEYPAD_BUTTON_PRESSED)
 				{
+#if KEYPAD_WAKE_ON_INT2
+					g_idleScans = 0;
+#endif
 					#if (KEYPAD_NUM_COLS == 3)
 						#ifdef STANDARD_KEYPAD
 							return ((row*KEYPAD_NUM_COLS)+col+1);
@@ -88,6 +161,14 @@ uint8 KEYPAD_getPressedKey(void)
 			GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID,KEYPAD_FIRST_ROW_PIN_ID+row,PIN_INPUT);
 			_delay_ms(5); /* Add small delay to fix CPU load issue in proteus */
 		}
+#if KEYPAD_WAKE_ON_INT2
+		/* back to sleep after a while without any key */
+		g_idleScans++;
+		if(g_idleScans >= (KEYPAD_SCAN_TIMEOUT_MS / KEYPAD_SCAN_MS))
+		{
+			g_isScanning = FALSE;
+		}
+#endif
 	}	
 }
 
@@ -22,9 +22,27 @@
 #define KEYPAD_NUM_COLS                   4
 #define KEYPAD_NUM_ROWS                   4
 
+/*
+ * Key-press wake-up: while nobody uses the keypad all the rows are driven low and the CPU
+ * sleeps. The columns are joined to INT2 (PB2) by one diode each (cathode on the column,
+ * pull-up on PB2), so the first press pulls INT2 low and wakes the CPU. The matrix is then
+ * scanned until no key was pressed for KEYPAD_SCAN_TIMEOUT_MS.
+ * PB2 is a row in the original wiring, so in this mode the rows move to PA4..PA7.
+ * 0 keeps the original wiring and the continuous scan.
+ */
+#define KEYPAD_WAKE_ON_INT2               0
+#define KEYPAD_WAKE_PORT_ID               PORTB_ID
+#define KEYPAD_WAKE_PIN_ID                PIN2_ID
+#define KEYPAD_SCAN_TIMEOUT_MS            5000
+
 /* Keypad Port Configurations */
+#if KEYPAD_WAKE_ON_INT2
+#define KEYPAD_ROW_PORT_ID                PORTA_ID
+#define KEYPAD_FIRST_ROW_PIN_ID           PIN4_ID
+#else
 #define KEYPAD_ROW_PORT_ID                PORTB_ID
 #define KEYPAD_FIRST_ROW_PIN_ID           PIN0_ID
+#endif
 
 #define KEYPAD_COL_PORT_ID                PORTB_ID
 #define KEYPAD_FIRST_COL_PIN_ID           PIN4_ID
@@ -39,7 +57,7 @@
 
 /*
  * Description :
- * Get the Keypad pressed button
+ * Get the Keypad pressed button, sleeping until the first press in the wake-up mode
  */
 uint8 KEYPAD_getPressedKey(void);
 
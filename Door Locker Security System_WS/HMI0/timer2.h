@@ -0,0 +1,54 @@
+/*
+ * timer2.h
+ *
+ *      Author: Ayman_Mostafa
+ */
+
+#ifndef TIMER2_H_
+#define TIMER2_H_
+
+#include "std_types.h"
+
+
+/*******************************************************************************
+ *                       definitions                                    *
+ *******************************************************************************/
+
+typedef enum
+{
+	TIMER2_NO_CLOCK,TIMER2_NO_PRESCALING,TIMER2_PRESCALE_8,TIMER2_PRESCALE_32,TIMER2_PRESCALE_64,
+	TIMER2_PRESCALE_128,TIMER2_PRESCALE_256,TIMER2_PRESCALE_1024
+}Timer2_Prescaler;
+
+typedef enum
+{
+	TIMER2_NORMAL_MODE,TIMER2_COMPARE_MODE
+}Timer2_Mode;
+
+typedef struct {
+ uint8 initial_value;
+ uint8 compare_value; // it will be used in compare mode only.
+ Timer2_Prescaler prescaler;
+ Timer2_Mode mode;
+} Timer2_ConfigType;
+
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/* Description
+⮚ Function to initialize the Timer2 driver*/
+void Timer2_init(const Timer2_ConfigType * Config_Ptr);
+
+/*Description
+⮚ Function to disable the Timer2.*/
+void Timer2_deInit(void);
+
+
+/*Description
+⮚ Function to set the Call Back function address.*/
+void Timer2_setCallBack(void(*a_ptr)(void));
+
+
+#endif /* TIMER2_H_ */